@@ -12,11 +12,11 @@ LD = g++.exe
 WINDRES = windres.exe
 
 INC = 
-CFLAGS =  -Wall -fexceptions
+CFLAGS =  -Wall -fexceptions -pthread
 RESINC = 
 LIBDIR = 
 LIB = 
-LDFLAGS = 
+LDFLAGS =  -pthread
 
 INC_DEBUG =  $(INC) -Isrc -Isrc\Z80 -Isrc\Memory
 CFLAGS_DEBUG =  $(CFLAGS) -std=c++11 -g
@@ -40,18 +40,37 @@ OBJDIR_RELEASE = obj\\Release
 DEP_RELEASE = 
 OUT_RELEASE = bin\\Release\\WolfGB.exe
 
-OBJ_DEBUG = $(OBJDIR_DEBUG)\\src\\GPU\\GPU.o $(OBJDIR_DEBUG)\\src\\Memory\\MMU.o $(OBJDIR_DEBUG)\\src\\Z80\\Instructions.o $(OBJDIR_DEBUG)\\src\\Z80\\Registers.o $(OBJDIR_DEBUG)\\src\\Z80\\Z80.o $(OBJDIR_DEBUG)\\src\\main.o
+INC_TESTS =  $(INC) -Isrc -Isrc\Z80 -Isrc\Memory -Itests
+CFLAGS_TESTS =  $(CFLAGS) -std=c++11 -g
+RESINC_TESTS =  $(RESINC)
+RCFLAGS_TESTS =  $(RCFLAGS)
+LIBDIR_TESTS =  $(LIBDIR)
+LIB_TESTS = $(LIB)
+LDFLAGS_TESTS =  $(LDFLAGS)
+OBJDIR_TESTS = obj\\Tests
+DEP_TESTS = 
+OUT_TESTS = bin\\Tests\\WolfGBTests.exe
 
-OBJ_RELEASE = $(OBJDIR_RELEASE)\\src\\GPU\\GPU.o $(OBJDIR_RELEASE)\\src\\Memory\\MMU.o $(OBJDIR_RELEASE)\\src\\Z80\\Instructions.o $(OBJDIR_RELEASE)\\src\\Z80\\Registers.o $(OBJDIR_RELEASE)\\src\\Z80\\Z80.o $(OBJDIR_RELEASE)\\src\\main.o
+OBJ_DEBUG = $(OBJDIR_DEBUG)\\src\\Audio\\APU.o $(OBJDIR_DEBUG)\\src\\Audio\\AudioOutput.o $(OBJDIR_DEBUG)\\src\\Audio\\BlipBuffer.o $(OBJDIR_DEBUG)\\src\\Audio\\Resampler.o $(OBJDIR_DEBUG)\\src\\Capture\\AudioRecorder.o $(OBJDIR_DEBUG)\\src\\Capture\\ImageEncoder.o $(OBJDIR_DEBUG)\\src\\Capture\\Screenshots.o $(OBJDIR_DEBUG)\\src\\Capture\\VideoRecorder.o $(OBJDIR_DEBUG)\\src\\Display\\Display.o $(OBJDIR_DEBUG)\\src\\Display\\FramePacer.o $(OBJDIR_DEBUG)\\src\\Display\\Scaler.o $(OBJDIR_DEBUG)\\src\\Display\\TripleBuffer.o $(OBJDIR_DEBUG)\\src\\GPU\\GPU.o $(OBJDIR_DEBUG)\\src\\GPU\\PixelPipeline.o $(OBJDIR_DEBUG)\\src\\GPU\\Renderer.o $(OBJDIR_DEBUG)\\src\\GPU\\RenderWorker.o $(OBJDIR_DEBUG)\\src\\Input\\Joypad.o $(OBJDIR_DEBUG)\\src\\Memory\\MMU.o $(OBJDIR_DEBUG)\\src\\Memory\\PagedMemory.o $(OBJDIR_DEBUG)\\src\\State\\Movie.o $(OBJDIR_DEBUG)\\src\\State\\Rewind.o $(OBJDIR_DEBUG)\\src\\State\\SaveState.o $(OBJDIR_DEBUG)\\src\\State\\StateStream.o $(OBJDIR_DEBUG)\\src\\Util\\Hash.o $(OBJDIR_DEBUG)\\src\\Util\\ThreadPool.o $(OBJDIR_DEBUG)\\src\\Z80\\Instructions.o $(OBJDIR_DEBUG)\\src\\Z80\\Registers.o $(OBJDIR_DEBUG)\\src\\Z80\\Z80.o $(OBJDIR_DEBUG)\\src\\main.o
 
-all: debug release
+OBJ_RELEASE = $(OBJDIR_RELEASE)\\src\\Audio\\APU.o $(OBJDIR_RELEASE)\\src\\Audio\\AudioOutput.o $(OBJDIR_RELEASE)\\src\\Audio\\BlipBuffer.o $(OBJDIR_RELEASE)\\src\\Audio\\Resampler.o $(OBJDIR_RELEASE)\\src\\Capture\\AudioRecorder.o $(OBJDIR_RELEASE)\\src\\Capture\\ImageEncoder.o $(OBJDIR_RELEASE)\\src\\Capture\\Screenshots.o $(OBJDIR_RELEASE)\\src\\Capture\\VideoRecorder.o $(OBJDIR_RELEASE)\\src\\Display\\Display.o $(OBJDIR_RELEASE)\\src\\Display\\FramePacer.o $(OBJDIR_RELEASE)\\src\\Display\\Scaler.o $(OBJDIR_RELEASE)\\src\\Display\\TripleBuffer.o $(OBJDIR_RELEASE)\\src\\GPU\\GPU.o $(OBJDIR_RELEASE)\\src\\GPU\\PixelPipeline.o $(OBJDIR_RELEASE)\\src\\GPU\\Renderer.o $(OBJDIR_RELEASE)\\src\\GPU\\RenderWorker.o $(OBJDIR_RELEASE)\\src\\Input\\Joypad.o $(OBJDIR_RELEASE)\\src\\Memory\\MMU.o $(OBJDIR_RELEASE)\\src\\Memory\\PagedMemory.o $(OBJDIR_RELEASE)\\src\\State\\Movie.o $(OBJDIR_RELEASE)\\src\\State\\Rewind.o $(OBJDIR_RELEASE)\\src\\State\\SaveState.o $(OBJDIR_RELEASE)\\src\\State\\StateStream.o $(OBJDIR_RELEASE)\\src\\Util\\Hash.o $(OBJDIR_RELEASE)\\src\\Util\\ThreadPool.o $(OBJDIR_RELEASE)\\src\\Z80\\Instructions.o $(OBJDIR_RELEASE)\\src\\Z80\\Registers.o $(OBJDIR_RELEASE)\\src\\Z80\\Z80.o $(OBJDIR_RELEASE)\\src\\main.o
 
-clean: clean_debug clean_release
+OBJ_TESTS = $(OBJDIR_TESTS)\\src\\Audio\\APU.o $(OBJDIR_TESTS)\\src\\Audio\\AudioOutput.o $(OBJDIR_TESTS)\\src\\Audio\\BlipBuffer.o $(OBJDIR_TESTS)\\src\\Audio\\Resampler.o $(OBJDIR_TESTS)\\src\\Capture\\AudioRecorder.o $(OBJDIR_TESTS)\\src\\Capture\\ImageEncoder.o $(OBJDIR_TESTS)\\src\\Capture\\Screenshots.o $(OBJDIR_TESTS)\\src\\Capture\\VideoRecorder.o $(OBJDIR_TESTS)\\src\\Debug\\GDDB.o $(OBJDIR_TESTS)\\src\\Display\\Display.o $(OBJDIR_TESTS)\\src\\Display\\FramePacer.o $(OBJDIR_TESTS)\\src\\Display\\Scaler.o $(OBJDIR_TESTS)\\src\\Display\\TripleBuffer.o $(OBJDIR_TESTS)\\src\\GPU\\GPU.o $(OBJDIR_TESTS)\\src\\GPU\\PixelPipeline.o $(OBJDIR_TESTS)\\src\\GPU\\Renderer.o $(OBJDIR_TESTS)\\src\\GPU\\RenderWorker.o $(OBJDIR_TESTS)\\src\\Input\\Joypad.o $(OBJDIR_TESTS)\\src\\Memory\\IMemoryDevice.o $(OBJDIR_TESTS)\\src\\Memory\\MMU.o $(OBJDIR_TESTS)\\src\\Memory\\PagedMemory.o $(OBJDIR_TESTS)\\src\\State\\Movie.o $(OBJDIR_TESTS)\\src\\State\\Rewind.o $(OBJDIR_TESTS)\\src\\State\\SaveState.o $(OBJDIR_TESTS)\\src\\State\\StateStream.o $(OBJDIR_TESTS)\\src\\Util\\Hash.o $(OBJDIR_TESTS)\\src\\Util\\ThreadPool.o $(OBJDIR_TESTS)\\src\\Z80\\Instructions.o $(OBJDIR_TESTS)\\src\\Z80\\Registers.o $(OBJDIR_TESTS)\\src\\Z80\\Z80.o $(OBJDIR_TESTS)\\tests\\APUTests.o $(OBJDIR_TESTS)\\tests\\ForkTests.o $(OBJDIR_TESTS)\\tests\\HashTests.o $(OBJDIR_TESTS)\\tests\\InstructionTests.o $(OBJDIR_TESTS)\\tests\\PagedMemoryTests.o $(OBJDIR_TESTS)\\tests\\PixelPipelineTests.o $(OBJDIR_TESTS)\\tests\\ResamplerTests.o $(OBJDIR_TESTS)\\tests\\RewindTests.o $(OBJDIR_TESTS)\\tests\\SaveStateTests.o $(OBJDIR_TESTS)\\tests\\ScalerTests.o $(OBJDIR_TESTS)\\tests\\StateStreamTests.o $(OBJDIR_TESTS)\\tests\\Test.o $(OBJDIR_TESTS)\\tests\\TestMain.o
+
+all: debug release tests
+
+clean: clean_debug clean_release clean_tests
 
 before_debug: 
 	cmd /c if not exist bin\\Debug md bin\\Debug
+	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\Audio md $(OBJDIR_DEBUG)\\src\\Audio
+	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\Capture md $(OBJDIR_DEBUG)\\src\\Capture
+	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\Display md $(OBJDIR_DEBUG)\\src\\Display
 	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\GPU md $(OBJDIR_DEBUG)\\src\\GPU
+	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\Input md $(OBJDIR_DEBUG)\\src\\Input
 	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\Memory md $(OBJDIR_DEBUG)\\src\\Memory
+	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\State md $(OBJDIR_DEBUG)\\src\\State
+	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\Util md $(OBJDIR_DEBUG)\\src\\Util
 	cmd /c if not exist $(OBJDIR_DEBUG)\\src\\Z80 md $(OBJDIR_DEBUG)\\src\\Z80
 	cmd /c if not exist $(OBJDIR_DEBUG)\\src md $(OBJDIR_DEBUG)\\src
 
@@ -62,12 +81,81 @@ debug: before_debug out_debug after_debug
 out_debug: before_debug $(OBJ_DEBUG) $(DEP_DEBUG)
 	$(LD) $(LIBDIR_DEBUG) -o $(OUT_DEBUG) $(OBJ_DEBUG)  $(LDFLAGS_DEBUG) $(LIB_DEBUG)
 
+$(OBJDIR_DEBUG)\\src\\Audio\\APU.o: src\\Audio\\APU.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Audio\\APU.cpp -o $(OBJDIR_DEBUG)\\src\\Audio\\APU.o
+
+$(OBJDIR_DEBUG)\\src\\Audio\\AudioOutput.o: src\\Audio\\AudioOutput.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Audio\\AudioOutput.cpp -o $(OBJDIR_DEBUG)\\src\\Audio\\AudioOutput.o
+
+$(OBJDIR_DEBUG)\\src\\Audio\\BlipBuffer.o: src\\Audio\\BlipBuffer.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Audio\\BlipBuffer.cpp -o $(OBJDIR_DEBUG)\\src\\Audio\\BlipBuffer.o
+
+$(OBJDIR_DEBUG)\\src\\Audio\\Resampler.o: src\\Audio\\Resampler.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Audio\\Resampler.cpp -o $(OBJDIR_DEBUG)\\src\\Audio\\Resampler.o
+
+$(OBJDIR_DEBUG)\\src\\Capture\\AudioRecorder.o: src\\Capture\\AudioRecorder.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Capture\\AudioRecorder.cpp -o $(OBJDIR_DEBUG)\\src\\Capture\\AudioRecorder.o
+
+$(OBJDIR_DEBUG)\\src\\Capture\\ImageEncoder.o: src\\Capture\\ImageEncoder.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Capture\\ImageEncoder.cpp -o $(OBJDIR_DEBUG)\\src\\Capture\\ImageEncoder.o
+
+$(OBJDIR_DEBUG)\\src\\Capture\\Screenshots.o: src\\Capture\\Screenshots.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Capture\\Screenshots.cpp -o $(OBJDIR_DEBUG)\\src\\Capture\\Screenshots.o
+
+$(OBJDIR_DEBUG)\\src\\Capture\\VideoRecorder.o: src\\Capture\\VideoRecorder.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Capture\\VideoRecorder.cpp -o $(OBJDIR_DEBUG)\\src\\Capture\\VideoRecorder.o
+
+$(OBJDIR_DEBUG)\\src\\Display\\Display.o: src\\Display\\Display.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Display\\Display.cpp -o $(OBJDIR_DEBUG)\\src\\Display\\Display.o
+
+$(OBJDIR_DEBUG)\\src\\Display\\FramePacer.o: src\\Display\\FramePacer.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Display\\FramePacer.cpp -o $(OBJDIR_DEBUG)\\src\\Display\\FramePacer.o
+
+$(OBJDIR_DEBUG)\\src\\Display\\Scaler.o: src\\Display\\Scaler.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Display\\Scaler.cpp -o $(OBJDIR_DEBUG)\\src\\Display\\Scaler.o
+
+$(OBJDIR_DEBUG)\\src\\Display\\TripleBuffer.o: src\\Display\\TripleBuffer.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Display\\TripleBuffer.cpp -o $(OBJDIR_DEBUG)\\src\\Display\\TripleBuffer.o
+
 $(OBJDIR_DEBUG)\\src\\GPU\\GPU.o: src\\GPU\\GPU.cpp
 	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\GPU\\GPU.cpp -o $(OBJDIR_DEBUG)\\src\\GPU\\GPU.o
 
+$(OBJDIR_DEBUG)\\src\\GPU\\PixelPipeline.o: src\\GPU\\PixelPipeline.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\GPU\\PixelPipeline.cpp -o $(OBJDIR_DEBUG)\\src\\GPU\\PixelPipeline.o
+
+$(OBJDIR_DEBUG)\\src\\GPU\\Renderer.o: src\\GPU\\Renderer.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\GPU\\Renderer.cpp -o $(OBJDIR_DEBUG)\\src\\GPU\\Renderer.o
+
+$(OBJDIR_DEBUG)\\src\\GPU\\RenderWorker.o: src\\GPU\\RenderWorker.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\GPU\\RenderWorker.cpp -o $(OBJDIR_DEBUG)\\src\\GPU\\RenderWorker.o
+
+$(OBJDIR_DEBUG)\\src\\Input\\Joypad.o: src\\Input\\Joypad.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Input\\Joypad.cpp -o $(OBJDIR_DEBUG)\\src\\Input\\Joypad.o
+
 $(OBJDIR_DEBUG)\\src\\Memory\\MMU.o: src\\Memory\\MMU.cpp
 	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Memory\\MMU.cpp -o $(OBJDIR_DEBUG)\\src\\Memory\\MMU.o
 
+$(OBJDIR_DEBUG)\\src\\Memory\\PagedMemory.o: src\\Memory\\PagedMemory.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Memory\\PagedMemory.cpp -o $(OBJDIR_DEBUG)\\src\\Memory\\PagedMemory.o
+
+$(OBJDIR_DEBUG)\\src\\State\\Movie.o: src\\State\\Movie.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\State\\Movie.cpp -o $(OBJDIR_DEBUG)\\src\\State\\Movie.o
+
+$(OBJDIR_DEBUG)\\src\\State\\Rewind.o: src\\State\\Rewind.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\State\\Rewind.cpp -o $(OBJDIR_DEBUG)\\src\\State\\Rewind.o
+
+$(OBJDIR_DEBUG)\\src\\State\\SaveState.o: src\\State\\SaveState.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\State\\SaveState.cpp -o $(OBJDIR_DEBUG)\\src\\State\\SaveState.o
+
+$(OBJDIR_DEBUG)\\src\\State\\StateStream.o: src\\State\\StateStream.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\State\\StateStream.cpp -o $(OBJDIR_DEBUG)\\src\\State\\StateStream.o
+
+$(OBJDIR_DEBUG)\\src\\Util\\Hash.o: src\\Util\\Hash.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Util\\Hash.cpp -o $(OBJDIR_DEBUG)\\src\\Util\\Hash.o
+
+$(OBJDIR_DEBUG)\\src\\Util\\ThreadPool.o: src\\Util\\ThreadPool.cpp
+	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Util\\ThreadPool.cpp -o $(OBJDIR_DEBUG)\\src\\Util\\ThreadPool.o
+
 $(OBJDIR_DEBUG)\\src\\Z80\\Instructions.o: src\\Z80\\Instructions.cpp
 	$(CXX) $(CFLAGS_DEBUG) $(INC_DEBUG) -c src\\Z80\\Instructions.cpp -o $(OBJDIR_DEBUG)\\src\\Z80\\Instructions.o
 
@@ -83,15 +171,27 @@ $(OBJDIR_DEBUG)\\src\\main.o: src\\main.cpp
 clean_debug: 
 	cmd /c del /f $(OBJ_DEBUG) $(OUT_DEBUG)
 	cmd /c rd bin\\Debug
+	cmd /c rd $(OBJDIR_DEBUG)\\src\\Audio
+	cmd /c rd $(OBJDIR_DEBUG)\\src\\Capture
+	cmd /c rd $(OBJDIR_DEBUG)\\src\\Display
 	cmd /c rd $(OBJDIR_DEBUG)\\src\\GPU
+	cmd /c rd $(OBJDIR_DEBUG)\\src\\Input
 	cmd /c rd $(OBJDIR_DEBUG)\\src\\Memory
+	cmd /c rd $(OBJDIR_DEBUG)\\src\\State
+	cmd /c rd $(OBJDIR_DEBUG)\\src\\Util
 	cmd /c rd $(OBJDIR_DEBUG)\\src\\Z80
 	cmd /c rd $(OBJDIR_DEBUG)\\src
 
 before_release: 
 	cmd /c if not exist bin\\Release md bin\\Release
+	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\Audio md $(OBJDIR_RELEASE)\\src\\Audio
+	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\Capture md $(OBJDIR_RELEASE)\\src\\Capture
+	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\Display md $(OBJDIR_RELEASE)\\src\\Display
 	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\GPU md $(OBJDIR_RELEASE)\\src\\GPU
+	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\Input md $(OBJDIR_RELEASE)\\src\\Input
 	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\Memory md $(OBJDIR_RELEASE)\\src\\Memory
+	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\State md $(OBJDIR_RELEASE)\\src\\State
+	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\Util md $(OBJDIR_RELEASE)\\src\\Util
 	cmd /c if not exist $(OBJDIR_RELEASE)\\src\\Z80 md $(OBJDIR_RELEASE)\\src\\Z80
 	cmd /c if not exist $(OBJDIR_RELEASE)\\src md $(OBJDIR_RELEASE)\\src
 
@@ -102,12 +202,81 @@ release: before_release out_release after_release
 out_release: before_release $(OBJ_RELEASE) $(DEP_RELEASE)
 	$(LD) $(LIBDIR_RELEASE) -o $(OUT_RELEASE) $(OBJ_RELEASE)  $(LDFLAGS_RELEASE) $(LIB_RELEASE)
 
+$(OBJDIR_RELEASE)\\src\\Audio\\APU.o: src\\Audio\\APU.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Audio\\APU.cpp -o $(OBJDIR_RELEASE)\\src\\Audio\\APU.o
+
+$(OBJDIR_RELEASE)\\src\\Audio\\AudioOutput.o: src\\Audio\\AudioOutput.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Audio\\AudioOutput.cpp -o $(OBJDIR_RELEASE)\\src\\Audio\\AudioOutput.o
+
+$(OBJDIR_RELEASE)\\src\\Audio\\BlipBuffer.o: src\\Audio\\BlipBuffer.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Audio\\BlipBuffer.cpp -o $(OBJDIR_RELEASE)\\src\\Audio\\BlipBuffer.o
+
+$(OBJDIR_RELEASE)\\src\\Audio\\Resampler.o: src\\Audio\\Resampler.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Audio\\Resampler.cpp -o $(OBJDIR_RELEASE)\\src\\Audio\\Resampler.o
+
+$(OBJDIR_RELEASE)\\src\\Capture\\AudioRecorder.o: src\\Capture\\AudioRecorder.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Capture\\AudioRecorder.cpp -o $(OBJDIR_RELEASE)\\src\\Capture\\AudioRecorder.o
+
+$(OBJDIR_RELEASE)\\src\\Capture\\ImageEncoder.o: src\\Capture\\ImageEncoder.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Capture\\ImageEncoder.cpp -o $(OBJDIR_RELEASE)\\src\\Capture\\ImageEncoder.o
+
+$(OBJDIR_RELEASE)\\src\\Capture\\Screenshots.o: src\\Capture\\Screenshots.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Capture\\Screenshots.cpp -o $(OBJDIR_RELEASE)\\src\\Capture\\Screenshots.o
+
+$(OBJDIR_RELEASE)\\src\\Capture\\VideoRecorder.o: src\\Capture\\VideoRecorder.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Capture\\VideoRecorder.cpp -o $(OBJDIR_RELEASE)\\src\\Capture\\VideoRecorder.o
+
+$(OBJDIR_RELEASE)\\src\\Display\\Display.o: src\\Display\\Display.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Display\\Display.cpp -o $(OBJDIR_RELEASE)\\src\\Display\\Display.o
+
+$(OBJDIR_RELEASE)\\src\\Display\\FramePacer.o: src\\Display\\FramePacer.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Display\\FramePacer.cpp -o $(OBJDIR_RELEASE)\\src\\Display\\FramePacer.o
+
+$(OBJDIR_RELEASE)\\src\\Display\\Scaler.o: src\\Display\\Scaler.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Display\\Scaler.cpp -o $(OBJDIR_RELEASE)\\src\\Display\\Scaler.o
+
+$(OBJDIR_RELEASE)\\src\\Display\\TripleBuffer.o: src\\Display\\TripleBuffer.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Display\\TripleBuffer.cpp -o $(OBJDIR_RELEASE)\\src\\Display\\TripleBuffer.o
+
 $(OBJDIR_RELEASE)\\src\\GPU\\GPU.o: src\\GPU\\GPU.cpp
 	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\GPU\\GPU.cpp -o $(OBJDIR_RELEASE)\\src\\GPU\\GPU.o
 
+$(OBJDIR_RELEASE)\\src\\GPU\\PixelPipeline.o: src\\GPU\\PixelPipeline.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\GPU\\PixelPipeline.cpp -o $(OBJDIR_RELEASE)\\src\\GPU\\PixelPipeline.o
+
+$(OBJDIR_RELEASE)\\src\\GPU\\Renderer.o: src\\GPU\\Renderer.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\GPU\\Renderer.cpp -o $(OBJDIR_RELEASE)\\src\\GPU\\Renderer.o
+
+$(OBJDIR_RELEASE)\\src\\GPU\\RenderWorker.o: src\\GPU\\RenderWorker.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\GPU\\RenderWorker.cpp -o $(OBJDIR_RELEASE)\\src\\GPU\\RenderWorker.o
+
+$(OBJDIR_RELEASE)\\src\\Input\\Joypad.o: src\\Input\\Joypad.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Input\\Joypad.cpp -o $(OBJDIR_RELEASE)\\src\\Input\\Joypad.o
+
 $(OBJDIR_RELEASE)\\src\\Memory\\MMU.o: src\\Memory\\MMU.cpp
 	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Memory\\MMU.cpp -o $(OBJDIR_RELEASE)\\src\\Memory\\MMU.o
 
+$(OBJDIR_RELEASE)\\src\\Memory\\PagedMemory.o: src\\Memory\\PagedMemory.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Memory\\PagedMemory.cpp -o $(OBJDIR_RELEASE)\\src\\Memory\\PagedMemory.o
+
+$(OBJDIR_RELEASE)\\src\\State\\Movie.o: src\\State\\Movie.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\State\\Movie.cpp -o $(OBJDIR_RELEASE)\\src\\State\\Movie.o
+
+$(OBJDIR_RELEASE)\\src\\State\\Rewind.o: src\\State\\Rewind.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\State\\Rewind.cpp -o $(OBJDIR_RELEASE)\\src\\State\\Rewind.o
+
+$(OBJDIR_RELEASE)\\src\\State\\SaveState.o: src\\State\\SaveState.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\State\\SaveState.cpp -o $(OBJDIR_RELEASE)\\src\\State\\SaveState.o
+
+$(OBJDIR_RELEASE)\\src\\State\\StateStream.o: src\\State\\StateStream.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\State\\StateStream.cpp -o $(OBJDIR_RELEASE)\\src\\State\\StateStream.o
+
+$(OBJDIR_RELEASE)\\src\\Util\\Hash.o: src\\Util\\Hash.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Util\\Hash.cpp -o $(OBJDIR_RELEASE)\\src\\Util\\Hash.o
+
+$(OBJDIR_RELEASE)\\src\\Util\\ThreadPool.o: src\\Util\\ThreadPool.cpp
+	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Util\\ThreadPool.cpp -o $(OBJDIR_RELEASE)\\src\\Util\\ThreadPool.o
+
 $(OBJDIR_RELEASE)\\src\\Z80\\Instructions.o: src\\Z80\\Instructions.cpp
 	$(CXX) $(CFLAGS_RELEASE) $(INC_RELEASE) -c src\\Z80\\Instructions.cpp -o $(OBJDIR_RELEASE)\\src\\Z80\\Instructions.o
 
@@ -123,10 +292,183 @@ $(OBJDIR_RELEASE)\\src\\main.o: src\\main.cpp
 clean_release: 
 	cmd /c del /f $(OBJ_RELEASE) $(OUT_RELEASE)
 	cmd /c rd bin\\Release
+	cmd /c rd $(OBJDIR_RELEASE)\\src\\Audio
+	cmd /c rd $(OBJDIR_RELEASE)\\src\\Capture
+	cmd /c rd $(OBJDIR_RELEASE)\\src\\Display
 	cmd /c rd $(OBJDIR_RELEASE)\\src\\GPU
+	cmd /c rd $(OBJDIR_RELEASE)\\src\\Input
 	cmd /c rd $(OBJDIR_RELEASE)\\src\\Memory
+	cmd /c rd $(OBJDIR_RELEASE)\\src\\State
+	cmd /c rd $(OBJDIR_RELEASE)\\src\\Util
 	cmd /c rd $(OBJDIR_RELEASE)\\src\\Z80
 	cmd /c rd $(OBJDIR_RELEASE)\\src
 
-.PHONY: before_debug after_debug clean_debug before_release after_release clean_release
+before_tests: 
+	cmd /c if not exist bin\\Tests md bin\\Tests
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Audio md $(OBJDIR_TESTS)\\src\\Audio
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Capture md $(OBJDIR_TESTS)\\src\\Capture
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Debug md $(OBJDIR_TESTS)\\src\\Debug
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Display md $(OBJDIR_TESTS)\\src\\Display
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\GPU md $(OBJDIR_TESTS)\\src\\GPU
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Input md $(OBJDIR_TESTS)\\src\\Input
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Memory md $(OBJDIR_TESTS)\\src\\Memory
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\State md $(OBJDIR_TESTS)\\src\\State
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Util md $(OBJDIR_TESTS)\\src\\Util
+	cmd /c if not exist $(OBJDIR_TESTS)\\src\\Z80 md $(OBJDIR_TESTS)\\src\\Z80
+	cmd /c if not exist $(OBJDIR_TESTS)\\src md $(OBJDIR_TESTS)\\src
+	cmd /c if not exist $(OBJDIR_TESTS)\\tests md $(OBJDIR_TESTS)\\tests
+
+after_tests: 
+
+tests: before_tests out_tests after_tests
+
+out_tests: before_tests $(OBJ_TESTS) $(DEP_TESTS)
+	$(LD) $(LIBDIR_TESTS) -o $(OUT_TESTS) $(OBJ_TESTS)  $(LDFLAGS_TESTS) $(LIB_TESTS)
+
+$(OBJDIR_TESTS)\\src\\Audio\\APU.o: src\\Audio\\APU.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Audio\\APU.cpp -o $(OBJDIR_TESTS)\\src\\Audio\\APU.o
+
+$(OBJDIR_TESTS)\\src\\Audio\\AudioOutput.o: src\\Audio\\AudioOutput.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Audio\\AudioOutput.cpp -o $(OBJDIR_TESTS)\\src\\Audio\\AudioOutput.o
+
+$(OBJDIR_TESTS)\\src\\Audio\\BlipBuffer.o: src\\Audio\\BlipBuffer.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Audio\\BlipBuffer.cpp -o $(OBJDIR_TESTS)\\src\\Audio\\BlipBuffer.o
+
+$(OBJDIR_TESTS)\\src\\Audio\\Resampler.o: src\\Audio\\Resampler.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Audio\\Resampler.cpp -o $(OBJDIR_TESTS)\\src\\Audio\\Resampler.o
+
+$(OBJDIR_TESTS)\\src\\Capture\\AudioRecorder.o: src\\Capture\\AudioRecorder.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Capture\\AudioRecorder.cpp -o $(OBJDIR_TESTS)\\src\\Capture\\AudioRecorder.o
+
+$(OBJDIR_TESTS)\\src\\Capture\\ImageEncoder.o: src\\Capture\\ImageEncoder.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Capture\\ImageEncoder.cpp -o $(OBJDIR_TESTS)\\src\\Capture\\ImageEncoder.o
+
+$(OBJDIR_TESTS)\\src\\Capture\\Screenshots.o: src\\Capture\\Screenshots.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Capture\\Screenshots.cpp -o $(OBJDIR_TESTS)\\src\\Capture\\Screenshots.o
+
+$(OBJDIR_TESTS)\\src\\Capture\\VideoRecorder.o: src\\Capture\\VideoRecorder.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Capture\\VideoRecorder.cpp -o $(OBJDIR_TESTS)\\src\\Capture\\VideoRecorder.o
+
+$(OBJDIR_TESTS)\\src\\Debug\\GDDB.o: src\\Debug\\GDDB.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Debug\\GDDB.cpp -o $(OBJDIR_TESTS)\\src\\Debug\\GDDB.o
+
+$(OBJDIR_TESTS)\\src\\Display\\Display.o: src\\Display\\Display.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Display\\Display.cpp -o $(OBJDIR_TESTS)\\src\\Display\\Display.o
+
+$(OBJDIR_TESTS)\\src\\Display\\FramePacer.o: src\\Display\\FramePacer.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Display\\FramePacer.cpp -o $(OBJDIR_TESTS)\\src\\Display\\FramePacer.o
+
+$(OBJDIR_TESTS)\\src\\Display\\Scaler.o: src\\Display\\Scaler.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Display\\Scaler.cpp -o $(OBJDIR_TESTS)\\src\\Display\\Scaler.o
+
+$(OBJDIR_TESTS)\\src\\Display\\TripleBuffer.o: src\\Display\\TripleBuffer.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Display\\TripleBuffer.cpp -o $(OBJDIR_TESTS)\\src\\Display\\TripleBuffer.o
+
+$(OBJDIR_TESTS)\\src\\GPU\\GPU.o: src\\GPU\\GPU.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\GPU\\GPU.cpp -o $(OBJDIR_TESTS)\\src\\GPU\\GPU.o
+
+$(OBJDIR_TESTS)\\src\\GPU\\PixelPipeline.o: src\\GPU\\PixelPipeline.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\GPU\\PixelPipeline.cpp -o $(OBJDIR_TESTS)\\src\\GPU\\PixelPipeline.o
+
+$(OBJDIR_TESTS)\\src\\GPU\\Renderer.o: src\\GPU\\Renderer.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\GPU\\Renderer.cpp -o $(OBJDIR_TESTS)\\src\\GPU\\Renderer.o
+
+$(OBJDIR_TESTS)\\src\\GPU\\RenderWorker.o: src\\GPU\\RenderWorker.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\GPU\\RenderWorker.cpp -o $(OBJDIR_TESTS)\\src\\GPU\\RenderWorker.o
+
+$(OBJDIR_TESTS)\\src\\Input\\Joypad.o: src\\Input\\Joypad.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Input\\Joypad.cpp -o $(OBJDIR_TESTS)\\src\\Input\\Joypad.o
+
+$(OBJDIR_TESTS)\\src\\Memory\\IMemoryDevice.o: src\\Memory\\IMemoryDevice.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Memory\\IMemoryDevice.cpp -o $(OBJDIR_TESTS)\\src\\Memory\\IMemoryDevice.o
+
+$(OBJDIR_TESTS)\\src\\Memory\\MMU.o: src\\Memory\\MMU.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Memory\\MMU.cpp -o $(OBJDIR_TESTS)\\src\\Memory\\MMU.o
+
+$(OBJDIR_TESTS)\\src\\Memory\\PagedMemory.o: src\\Memory\\PagedMemory.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Memory\\PagedMemory.cpp -o $(OBJDIR_TESTS)\\src\\Memory\\PagedMemory.o
+
+$(OBJDIR_TESTS)\\src\\State\\Movie.o: src\\State\\Movie.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\State\\Movie.cpp -o $(OBJDIR_TESTS)\\src\\State\\Movie.o
+
+$(OBJDIR_TESTS)\\src\\State\\Rewind.o: src\\State\\Rewind.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\State\\Rewind.cpp -o $(OBJDIR_TESTS)\\src\\State\\Rewind.o
+
+$(OBJDIR_TESTS)\\src\\State\\SaveState.o: src\\State\\SaveState.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\State\\SaveState.cpp -o $(OBJDIR_TESTS)\\src\\State\\SaveState.o
+
+$(OBJDIR_TESTS)\\src\\State\\StateStream.o: src\\State\\StateStream.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\State\\StateStream.cpp -o $(OBJDIR_TESTS)\\src\\State\\StateStream.o
+
+$(OBJDIR_TESTS)\\src\\Util\\Hash.o: src\\Util\\Hash.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Util\\Hash.cpp -o $(OBJDIR_TESTS)\\src\\Util\\Hash.o
+
+$(OBJDIR_TESTS)\\src\\Util\\ThreadPool.o: src\\Util\\ThreadPool.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Util\\ThreadPool.cpp -o $(OBJDIR_TESTS)\\src\\Util\\ThreadPool.o
+
+$(OBJDIR_TESTS)\\src\\Z80\\Instructions.o: src\\Z80\\Instructions.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Z80\\Instructions.cpp -o $(OBJDIR_TESTS)\\src\\Z80\\Instructions.o
+
+$(OBJDIR_TESTS)\\src\\Z80\\Registers.o: src\\Z80\\Registers.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Z80\\Registers.cpp -o $(OBJDIR_TESTS)\\src\\Z80\\Registers.o
+
+$(OBJDIR_TESTS)\\src\\Z80\\Z80.o: src\\Z80\\Z80.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c src\\Z80\\Z80.cpp -o $(OBJDIR_TESTS)\\src\\Z80\\Z80.o
+
+$(OBJDIR_TESTS)\\tests\\APUTests.o: tests\\APUTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\APUTests.cpp -o $(OBJDIR_TESTS)\\tests\\APUTests.o
+
+$(OBJDIR_TESTS)\\tests\\ForkTests.o: tests\\ForkTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\ForkTests.cpp -o $(OBJDIR_TESTS)\\tests\\ForkTests.o
+
+$(OBJDIR_TESTS)\\tests\\HashTests.o: tests\\HashTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\HashTests.cpp -o $(OBJDIR_TESTS)\\tests\\HashTests.o
+
+$(OBJDIR_TESTS)\\tests\\InstructionTests.o: tests\\InstructionTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\InstructionTests.cpp -o $(OBJDIR_TESTS)\\tests\\InstructionTests.o
+
+$(OBJDIR_TESTS)\\tests\\PagedMemoryTests.o: tests\\PagedMemoryTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\PagedMemoryTests.cpp -o $(OBJDIR_TESTS)\\tests\\PagedMemoryTests.o
+
+$(OBJDIR_TESTS)\\tests\\PixelPipelineTests.o: tests\\PixelPipelineTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\PixelPipelineTests.cpp -o $(OBJDIR_TESTS)\\tests\\PixelPipelineTests.o
+
+$(OBJDIR_TESTS)\\tests\\ResamplerTests.o: tests\\ResamplerTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\ResamplerTests.cpp -o $(OBJDIR_TESTS)\\tests\\ResamplerTests.o
+
+$(OBJDIR_TESTS)\\tests\\RewindTests.o: tests\\RewindTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\RewindTests.cpp -o $(OBJDIR_TESTS)\\tests\\RewindTests.o
+
+$(OBJDIR_TESTS)\\tests\\SaveStateTests.o: tests\\SaveStateTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\SaveStateTests.cpp -o $(OBJDIR_TESTS)\\tests\\SaveStateTests.o
+
+$(OBJDIR_TESTS)\\tests\\ScalerTests.o: tests\\ScalerTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\ScalerTests.cpp -o $(OBJDIR_TESTS)\\tests\\ScalerTests.o
+
+$(OBJDIR_TESTS)\\tests\\StateStreamTests.o: tests\\StateStreamTests.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\StateStreamTests.cpp -o $(OBJDIR_TESTS)\\tests\\StateStreamTests.o
+
+$(OBJDIR_TESTS)\\tests\\Test.o: tests\\Test.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\Test.cpp -o $(OBJDIR_TESTS)\\tests\\Test.o
+
+$(OBJDIR_TESTS)\\tests\\TestMain.o: tests\\TestMain.cpp
+	$(CXX) $(CFLAGS_TESTS) $(INC_TESTS) -c tests\\TestMain.cpp -o $(OBJDIR_TESTS)\\tests\\TestMain.o
+
+clean_tests: 
+	cmd /c del /f $(OBJ_TESTS) $(OUT_TESTS)
+	cmd /c rd bin\\Tests
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Audio
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Capture
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Debug
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Display
+	cmd /c rd $(OBJDIR_TESTS)\\src\\GPU
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Input
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Memory
+	cmd /c rd $(OBJDIR_TESTS)\\src\\State
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Util
+	cmd /c rd $(OBJDIR_TESTS)\\src\\Z80
+	cmd /c rd $(OBJDIR_TESTS)\\src
+	cmd /c rd $(OBJDIR_TESTS)\\tests
+
+.PHONY: before_debug after_debug clean_debug before_release after_release clean_release before_tests after_tests clean_tests
 
@@ -0,0 +1,760 @@
+#include "APU.h"
+
+#include <string.h>
+#include <algorithm>
+
+using namespace std;
+
+// Output of the square channels at each of the 8 steps of the 4 duty cycles
+static const uint8_t DutyTable[4][8] =
+{
+    { 0, 0, 0, 0, 0, 0, 0, 1 }, // 12.5%
+    { 1, 0, 0, 0, 0, 0, 0, 1 }, // 25%
+    { 1, 0, 0, 0, 0, 1, 1, 1 }, // 50%
+    { 0, 1, 1, 1, 1, 1, 1, 0 }, // 75%
+};
+
+// Bits that always read back as 1, for 0xFF10-0xFF2F
+static const uint8_t ReadMasks[0x20] =
+{
+    0x80, 0x3F, 0x00, 0xFF, 0xBF, // NR10-NR14
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF, // NR20-NR24
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF, // NR30-NR34
+    0xFF, 0xFF, 0x00, 0x00, 0xBF, // NR40-NR44
+    0x00, 0x00, 0x70, // NR50-NR52
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static const int NoiseDivisors[8] = { 8, 16, 32, 48, 64, 80, 96, 112 };
+
+// Steps from each position of a duty cycle until its output changes
+static uint8_t dutyRun[4][8];
+
+APU::APU()
+{
+    static bool initialised = (Init(), true);
+    (void)initialised;
+
+    left.SetRates(ClockRate, SynthesisRate);
+    right.SetRates(ClockRate, SynthesisRate);
+    silent = false;
+    tap = NULL;
+    SetSampleRate(48000);
+    Reset();
+}
+
+APU::~APU()
+{
+}
+
+void APU::Init()
+{
+    for (int duty = 0; duty < 4; duty++)
+    {
+        for (int position = 0; position < 8; position++)
+        {
+            int steps = 1;
+            while (DutyTable[duty][(position + steps) & 7] == DutyTable[duty][position])
+            {
+                steps++;
+            }
+            dutyRun[duty][position] = steps;
+        }
+    }
+}
+
+void APU::Reset()
+{
+    memset(channels, 0, sizeof(channels));
+    memset(registers, 0, sizeof(registers));
+    memset(outputLeft, 0, sizeof(outputLeft));
+    memset(outputRight, 0, sizeof(outputRight));
+    power = false;
+
+    time = 0;
+    runTime = 0;
+    sequencerTimer = SequencerCycles;
+    sequencerStep = 0;
+    readValue = 0;
+
+    left.Clear();
+    right.Clear();
+    resampler.Clear();
+}
+
+void APU::Step(uint8_t clockCycles)
+{
+    time += clockCycles;
+    if (time >= FrameCycles)
+    {
+        EndFrame();
+    }
+}
+
+void APU::SetSampleRate(int sampleRate)
+{
+    this->sampleRate = sampleRate;
+    resampler.Configure(SynthesisRate, sampleRate, resampler.GetQuality());
+}
+
+void APU::SetSilent(bool silent)
+{
+    if (silent == this->silent)
+    {
+        return;
+    }
+
+    EndFrame();
+    this->silent = silent;
+
+    // The blip buffers are left as they were, so sound picks up where it left off. Run-ahead
+    // relies on this to silence the frames it throws away without a click each frame.
+    UpdateAllOutputs(0);
+}
+
+int APU::GetSampleRate()
+{
+    return sampleRate;
+}
+
+void APU::SetResamplerQuality(ResamplerQuality quality)
+{
+    resampler.Configure(SynthesisRate, sampleRate, quality);
+}
+
+void APU::SetRateAdjustment(double ratio)
+{
+    resampler.SetRateAdjustment(ratio);
+}
+
+void APU::SetSynthesisTap(vector<StereoSample>* tap)
+{
+    this->tap = tap;
+}
+
+Resampler* APU::GetResampler()
+{
+    return &resampler;
+}
+
+int APU::ReadSamples(StereoSample* out, int count)
+{
+    EndFrame();
+    if (silent)
+    {
+        return 0;
+    }
+
+    // Only take as much from the blip buffers as the resampler needs, the rest waits for the next read
+    int read = resampler.Read(out, count);
+    while (read < count)
+    {
+        StereoSample block[BlockSamples];
+        int needed = min(resampler.InputNeeded(count - read), (int)BlockSamples);
+        int blocked = left.ReadSamples(&block->left, needed, 2);
+        right.ReadSamples(&block->right, blocked, 2);
+        if (blocked == 0)
+        {
+            break;
+        }
+        resampler.Write(block, blocked);
+        read += resampler.Read(out + read, count - read);
+    }
+    return read;
+}
+
+uint8_t* APU::GetMemoryPtr(uint16_t address)
+{
+    // Length counters and the sweep can switch channels off, so NR52 needs to be up to date
+    Run(time);
+
+    int offset = address - 0xFF10;
+    if (address >= 0xFF30)
+    {
+        readValue = registers[offset];
+    }
+    else if (address == (uint16_t)IORegisters::NR52)
+    {
+        readValue = power << 7 | 0x70;
+        for (int i = 0; i < 4; i++)
+        {
+            readValue |= channels[i].enabled << i;
+        }
+    }
+    else
+    {
+        readValue = registers[offset] | ReadMasks[offset];
+    }
+
+    // Writes go through WriteByte, writing through this pointer has no effect
+    return &readValue;
+}
+
+/** @brief Writes the APU's section of a save state
+ * The channels' timers count from the cycle they've been run up to, so once they're caught up
+ * with the CPU the state doesn't depend on where in the APU's frame it was saved. That keeps
+ * the sample timeline unbroken when a state is loaded.
+ *
+ * @return void
+ *
+ */
+void APU::SaveState(StateWriter& state)
+{
+    Run(time);
+
+    state.BeginSection(StateTag("APU "));
+    state.Write(channels);
+    state.Write(registers);
+    state.Write(power);
+    state.Write(sequencerTimer);
+    state.Write(sequencerStep);
+    state.EndSection();
+}
+
+void APU::LoadState(StateReader& state)
+{
+    // Finish the samples so far, the loaded state carries on from here
+    EndFrame();
+
+    state.OpenSection(StateTag("APU "));
+    state.Read(channels);
+    state.Read(registers);
+    state.Read(power);
+    state.Read(sequencerTimer);
+    state.Read(sequencerStep);
+
+    // The outputs step to the loaded channels' levels rather than restarting from silence
+    UpdateAllOutputs(0);
+}
+
+void APU::CheckState(StateReader& state)
+{
+    state.OpenSection(StateTag("APU "));
+    state.Skip(sizeof(channels));
+    state.Skip(sizeof(registers));
+    state.Skip(sizeof(power));
+    state.Skip(sizeof(sequencerTimer));
+    state.Skip(sizeof(sequencerStep));
+    state.CloseSection();
+}
+
+void APU::ForkFrom(APU& parent)
+{
+    parent.Run(parent.time);
+    EndFrame();
+
+    memcpy(channels, parent.channels, sizeof(channels));
+    memcpy(registers, parent.registers, sizeof(registers));
+    power = parent.power;
+    sequencerTimer = parent.sequencerTimer;
+    sequencerStep = parent.sequencerStep;
+
+    UpdateAllOutputs(0);
+}
+
+/** @brief Writes a sound register, catching the channels up to the current cycle first
+ *
+ * @param address uint16_t 0xFF10-0xFF3F
+ * @param data uint8_t
+ * @return void
+ *
+ */
+void APU::WriteByte(uint16_t address, uint8_t data)
+{
+    Run(time);
+
+    int offset = address - 0xFF10;
+
+    // Wave RAM
+    if (address >= 0xFF30)
+    {
+        registers[offset] = data;
+        return;
+    }
+
+    if (address == (uint16_t)IORegisters::NR52)
+    {
+        bool on = data & 0x80;
+        if (!on && power)
+        {
+            // Powering off clears every register and silences every channel
+            memset(registers, 0, (uint16_t)IORegisters::NR52 - 0xFF10);
+            memset(channels, 0, sizeof(channels));
+        }
+        else if (on && !power)
+        {
+            sequencerStep = 0;
+        }
+        power = on;
+        UpdateAllOutputs(runTime);
+        return;
+    }
+
+    // Only NR52 can be written while the APU is off
+    if (!power || offset >= 0x17)
+    {
+        return;
+    }
+
+    registers[offset] = data;
+
+    if (address == (uint16_t)IORegisters::NR50 || address == (uint16_t)IORegisters::NR51)
+    {
+        UpdateAllOutputs(runTime);
+        return;
+    }
+
+    // The channels' registers are 5 apart, NRx0-NRx4
+    int index = offset / 5;
+    Channel& channel = channels[index];
+
+    switch (offset % 5)
+    {
+    case 0:
+        if (index == 2)
+        {
+            channel.dacEnabled = data & 0x80;
+            channel.enabled &= channel.dacEnabled;
+        }
+        break;
+
+    case 1:
+        channel.duty = data >> 6;
+        channel.length = index == 2 ? 256 - data : 64 - (data & 0x3F);
+        break;
+
+    case 2:
+        if (index != 2)
+        {
+            channel.dacEnabled = (data & 0xF8) != 0;
+            channel.enabled &= channel.dacEnabled;
+        }
+        break;
+
+    case 3:
+        channel.frequency = (channel.frequency & 0x700) | data;
+        break;
+
+    case 4:
+        channel.frequency = (channel.frequency & 0xFF) | (data & 0x07) << 8;
+        channel.lengthEnabled = data & 0x40;
+        if (data & 0x80)
+        {
+            Trigger(index);
+        }
+        break;
+    }
+
+    UpdateOutput(index, runTime);
+}
+
+/** @brief Runs the channels and frame sequencer up to a cycle
+ *
+ * @param until uint32_t Cycles since the start of the frame
+ * @return void
+ *
+ */
+void APU::Run(uint32_t until)
+{
+    while (runTime < until)
+    {
+        uint32_t end = until - runTime < (uint32_t)sequencerTimer ? until : runTime + sequencerTimer;
+
+        // Silent or not the waveforms end up in the same place, so states don't depend on it
+        RunSquare(0, runTime, end);
+        RunSquare(1, runTime, end);
+        RunWave(runTime, end);
+        RunNoise(runTime, end);
+
+        sequencerTimer -= end - runTime;
+        runTime = end;
+
+        if (sequencerTimer == 0)
+        {
+            sequencerTimer = SequencerCycles;
+            if (power)
+            {
+                ClockSequencer();
+            }
+        }
+    }
+}
+
+/** @brief Finishes the samples up to the current cycle and starts a new frame
+ * If nobody is reading the samples, the oldest are thrown away.
+ *
+ * @return void
+ *
+ */
+void APU::EndFrame()
+{
+    Run(time);
+    if (silent)
+    {
+        time = 0;
+        runTime = 0;
+        return;
+    }
+
+    left.EndFrame(time);
+    right.EndFrame(time);
+    time = 0;
+    runTime = 0;
+
+    if (tap != NULL)
+    {
+        StereoSample block[BlockSamples];
+        int blocked;
+        while ((blocked = left.ReadSamples(&block->left, BlockSamples, 2)) > 0)
+        {
+            right.ReadSamples(&block->right, blocked, 2);
+            tap->insert(tap->end(), block, block + blocked);
+            resampler.Write(block, blocked);
+        }
+    }
+
+    int excess = left.SamplesAvailable() - SynthesisRate / 8;
+    if (excess > 0)
+    {
+        left.ReadSamples(NULL, excess, 1);
+        right.ReadSamples(NULL, excess, 1);
+    }
+}
+
+// Moves a waveform on by however many steps fit between start and end without producing output
+static void Advance(int& timer, int& position, int mask, int period, uint32_t start, uint32_t end)
+{
+    uint32_t t = start + timer;
+    if (t < end)
+    {
+        uint32_t steps = (end - t + period - 1) / period;
+        position = (position + steps) & mask;
+        t += steps * period;
+    }
+    timer = t - end;
+}
+
+void APU::RunSquare(int index, uint32_t start, uint32_t end)
+{
+    Channel& channel = channels[index];
+    int period = Period(index);
+
+    if (silent || !IsAudible(index))
+    {
+        Advance(channel.timer, channel.position, 7, period, start, end);
+        return;
+    }
+
+    // Skip straight to each point the output changes, twice a cycle at most
+    uint32_t t = start + channel.timer;
+    while (true)
+    {
+        int steps = dutyRun[channel.duty][channel.position];
+        uint32_t change = t + (steps - 1) * period;
+        if (change >= end)
+        {
+            break;
+        }
+        channel.position = (channel.position + steps) & 7;
+        UpdateOutput(index, change);
+        t = change + period;
+    }
+
+    channel.timer = t - start;
+    Advance(channel.timer, channel.position, 7, period, start, end);
+}
+
+void APU::RunWave(uint32_t start, uint32_t end)
+{
+    Channel& channel = channels[2];
+    int period = Period(2);
+
+    if (silent || !IsAudible(2))
+    {
+        int position = channel.position;
+        Advance(channel.timer, channel.position, 31, period, start, end);
+        if (channel.position != position)
+        {
+            channel.waveSample = registers[0x20 + channel.position / 2] >> (channel.position & 1 ? 0 : 4) & 0x0F;
+        }
+        return;
+    }
+
+    uint32_t t = start + channel.timer;
+    for (; t < end; t += period)
+    {
+        channel.position = (channel.position + 1) & 31;
+        channel.waveSample = registers[0x20 + channel.position / 2] >> (channel.position & 1 ? 0 : 4) & 0x0F;
+        UpdateOutput(2, t);
+    }
+    channel.timer = t - end;
+}
+
+void APU::RunNoise(uint32_t start, uint32_t end)
+{
+    Channel& channel = channels[3];
+    int period = Period(3);
+
+    // Shifts of 14 and 15 stop the shift register
+    if (period == 0)
+    {
+        return;
+    }
+    if (!channel.enabled)
+    {
+        Advance(channel.timer, channel.position, 0, period, start, end);
+        return;
+    }
+
+    // The shift register is clocked whenever the channel is on, heard or not
+    bool audible = !silent && IsAudible(3);
+    bool shortMode = registers[(uint16_t)IORegisters::NR43 - 0xFF10] & 0x08;
+    uint32_t t = start + channel.timer;
+    for (; t < end; t += period)
+    {
+        int bit = (channel.lfsr ^ (channel.lfsr >> 1)) & 1;
+        uint16_t previous = channel.lfsr;
+        channel.lfsr = (channel.lfsr >> 1) | bit << 14;
+        if (shortMode)
+        {
+            channel.lfsr = (channel.lfsr & ~0x40) | bit << 6;
+        }
+
+        // Stepped even when it can't be heard, what it holds is part of the state
+        if (audible && ((channel.lfsr ^ previous) & 1))
+        {
+            UpdateOutput(3, t);
+        }
+    }
+    channel.timer = t - end;
+}
+
+/** @brief Clocks the length counters (256Hz), sweep (128Hz) and envelopes (64Hz)
+ *
+ * @return void
+ *
+ */
+void APU::ClockSequencer()
+{
+    if (sequencerStep % 2 == 0)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            Channel& channel = channels[i];
+            if (channel.lengthEnabled && channel.length > 0 && --channel.length == 0)
+            {
+                channel.enabled = false;
+            }
+        }
+    }
+
+    if (sequencerStep == 2 || sequencerStep == 6)
+    {
+        Channel& channel = channels[0];
+        uint8_t sweep = Register(IORegisters::NR10);
+        int sweepPeriod = sweep >> 4 & 0x07;
+
+        if (--channel.sweepTimer <= 0)
+        {
+            channel.sweepTimer = sweepPeriod != 0 ? sweepPeriod : 8;
+            if (channel.sweepEnabled && sweepPeriod != 0)
+            {
+                int frequency = SweepFrequency();
+                if (frequency > 2047)
+                {
+                    channel.enabled = false;
+                }
+                else if ((sweep & 0x07) != 0)
+                {
+                    channel.sweepShadow = frequency;
+                    channel.frequency = frequency;
+                    Register(IORegisters::NR13) = frequency & 0xFF;
+                    Register(IORegisters::NR14) = (Register(IORegisters::NR14) & ~0x07) | frequency >> 8;
+                    if (SweepFrequency() > 2047)
+                    {
+                        channel.enabled = false;
+                    }
+                }
+            }
+        }
+    }
+
+    if (sequencerStep == 7)
+    {
+        const int envelopeChannels[] = { 0, 1, 3 };
+        for (int i = 0; i < 3; i++)
+        {
+            Channel& channel = channels[envelopeChannels[i]];
+            uint8_t envelope = registers[envelopeChannels[i] * 5 + 2];
+            int envelopePeriod = envelope & 0x07;
+
+            if (envelopePeriod != 0 && --channel.envelopeTimer <= 0)
+            {
+                channel.envelopeTimer = envelopePeriod;
+                if ((envelope & 0x08) && channel.volume < 15)
+                {
+                    channel.volume++;
+                }
+                else if (!(envelope & 0x08) && channel.volume > 0)
+                {
+                    channel.volume--;
+                }
+            }
+        }
+    }
+
+    sequencerStep = (sequencerStep + 1) & 7;
+    UpdateAllOutputs(runTime);
+}
+
+/** @brief Restarts a channel, when bit 7 of NRx4 is written
+ *
+ * @return void
+ *
+ */
+void APU::Trigger(int index)
+{
+    Channel& channel = channels[index];
+    channel.enabled = channel.dacEnabled;
+    if (channel.length == 0)
+    {
+        channel.length = index == 2 ? 256 : 64;
+    }
+    channel.timer = Period(index);
+
+    if (index != 2)
+    {
+        uint8_t envelope = registers[index * 5 + 2];
+        channel.volume = envelope >> 4;
+        channel.envelopeTimer = envelope & 0x07;
+    }
+
+    if (index == 0)
+    {
+        uint8_t sweep = Register(IORegisters::NR10);
+        channel.sweepShadow = channel.frequency;
+        channel.sweepTimer = (sweep >> 4 & 0x07) != 0 ? sweep >> 4 & 0x07 : 8;
+        channel.sweepEnabled = (sweep & 0x77) != 0;
+        if ((sweep & 0x07) != 0 && SweepFrequency() > 2047)
+        {
+            channel.enabled = false;
+        }
+    }
+    else if (index == 2)
+    {
+        channel.position = 0;
+    }
+    else if (index == 3)
+    {
+        channel.lfsr = 0x7FFF;
+    }
+}
+
+int APU::SweepFrequency()
+{
+    uint8_t sweep = Register(IORegisters::NR10);
+    int delta = channels[0].sweepShadow >> (sweep & 0x07);
+    return sweep & 0x08 ? channels[0].sweepShadow - delta : channels[0].sweepShadow + delta;
+}
+
+int APU::Period(int index)
+{
+    switch (index)
+    {
+    case 0:
+    case 1:
+        return (2048 - channels[index].frequency) * 4;
+    case 2:
+        return (2048 - channels[index].frequency) * 2;
+    default:
+        uint8_t polynomial = Register(IORegisters::NR43);
+        int shift = polynomial >> 4;
+        return shift >= 14 ? 0 : NoiseDivisors[polynomial & 0x07] << shift;
+    }
+}
+
+/** @brief Whether the channel can be heard, if not it's advanced without generating anything
+ *
+ * @return bool
+ *
+ */
+bool APU::IsAudible(int index)
+{
+    const Channel& channel = channels[index];
+    if (!channel.enabled || !channel.dacEnabled || (Register(IORegisters::NR51) & (0x11 << index)) == 0)
+    {
+        return false;
+    }
+    if (index == 2)
+    {
+        return (Register(IORegisters::NR32) & 0x60) != 0;
+    }
+    return channel.volume > 0;
+}
+
+/** @brief Works out what a channel is outputting and adds any change to the blip buffers
+ *
+ * @param index int Channel
+ * @param at uint32_t Cycles since the start of the frame
+ * @return void
+ *
+ */
+void APU::UpdateOutput(int index, uint32_t at)
+{
+    if (silent)
+    {
+        return;
+    }
+
+    Channel& channel = channels[index];
+    int level = 0;
+
+    if (channel.enabled && channel.dacEnabled)
+    {
+        switch (index)
+        {
+        case 0:
+        case 1:
+            level = DutyTable[channel.duty][channel.position] ? channel.volume : 0;
+            break;
+        case 2:
+        {
+            int volumeCode = Register(IORegisters::NR32) >> 5 & 0x03;
+            level = volumeCode == 0 ? 0 : channel.waveSample >> (volumeCode - 1);
+            break;
+        }
+        case 3:
+            level = channel.lfsr & 1 ? 0 : channel.volume;
+            break;
+        }
+    }
+
+    uint8_t masterVolume = Register(IORegisters::NR50);
+    uint8_t panning = Register(IORegisters::NR51);
+    int outLeft = panning >> (index + 4) & 1 ? level * ((masterVolume >> 4 & 0x07) + 1) * Volume : 0;
+    int outRight = panning >> index & 1 ? level * ((masterVolume & 0x07) + 1) * Volume : 0;
+
+    if (outLeft != outputLeft[index])
+    {
+        left.AddDelta(at, outLeft - outputLeft[index]);
+        outputLeft[index] = outLeft;
+    }
+    if (outRight != outputRight[index])
+    {
+        right.AddDelta(at, outRight - outputRight[index]);
+        outputRight[index] = outRight;
+    }
+}
+
+void APU::UpdateAllOutputs(uint32_t at)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        UpdateOutput(i, at);
+    }
+}
+
+uint8_t& APU::Register(IORegisters reg)
+{
+    return registers[(uint16_t)reg - 0xFF10];
+}
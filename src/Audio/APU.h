@@ -0,0 +1,156 @@
+#ifndef APU_H
+#define APU_H
+
+#include <stdint.h>
+#include "Audio/BlipBuffer.h"
+#include "Audio/Resampler.h"
+#include "Memory/IMemoryDevice.h"
+#include "State/StateStream.h"
+
+/** @brief The sound hardware: two square channels (the first with a frequency sweep), a wave channel and a noise channel
+ * The APU is clocked lazily. Step only counts cycles, and the channels are caught up to the
+ * current cycle when a register is read or written or when samples are read. Catching up only
+ * visits the points where a channel's output changes, and each change goes into a BlipBuffer
+ * per side, so synthesis costs nothing for silent channels. The blip buffers run at a fixed
+ * SynthesisRate and a Resampler takes their output to whatever rate the host wants.
+ * When nothing is listening, silent mode skips synthesis and only moves the waveforms on,
+ * which leaves the state exactly as it would have been with the sound being heard.
+ */
+class APU: public IMemoryDevice
+{
+public:
+    APU();
+    virtual ~APU();
+
+    static const int ClockRate = 4194304;
+    static const int SynthesisRate = ClockRate / 64; // Of the blip buffers, high enough to keep everything audible
+
+    void Reset();
+    void Step(uint8_t clockCycles);
+    void SetSampleRate(int sampleRate);
+    int GetSampleRate();
+    void SetResamplerQuality(ResamplerQuality quality);
+
+    /** @brief Stops generating samples, for when nobody would hear them
+     * The frame sequencer still runs, so length counters and the sweep switch channels off
+     * and NR52 reads the same as with sound. The waveforms and mixing are skipped and
+     * ReadSamples returns nothing. Cheap to switch, so it can be used for a few frames at a time.
+     *
+     * @param silent bool
+     * @return void
+     *
+     */
+    void SetSilent(bool silent);
+
+    /** @brief Generates slightly more or fewer samples per emulated second
+     * Used to keep an audio device's queue from slowly filling or draining when its clock and
+     * the clock pacing the emulation don't quite agree.
+     *
+     * @param ratio double 1.0 = exactly the sample rate
+     * @return void
+     *
+     */
+    void SetRateAdjustment(double ratio);
+
+    /** @brief Reads the samples generated so far
+     *
+     * @param out StereoSample*
+     * @param count int Most samples to read
+     * @return The number of samples read
+     *
+     */
+    int ReadSamples(StereoSample* out, int count);
+
+    /** @brief Keeps a copy of everything synthesised, before it's resampled
+     * While set, each frame's output is taken from the blip buffers as soon as the frame ends,
+     * at SynthesisRate, and appended to tap. Unlike what ReadSamples returns, this only depends
+     * on what the game did, not on the host's sample rate, resampler or rate adjustment.
+     *
+     * @param tap std::vector<StereoSample>* NULL to stop
+     * @return void
+     *
+     */
+    void SetSynthesisTap(std::vector<StereoSample>* tap);
+
+    Resampler* GetResampler();
+
+    uint8_t* GetMemoryPtr(uint16_t address);
+    void WriteByte(uint16_t address, uint8_t data);
+
+    void SaveState(StateWriter& state);
+    void LoadState(StateReader& state);
+    void CheckState(StateReader& state); // Skips what LoadState reads, see Z80::LoadState
+    void ForkFrom(APU& parent); // Copies what LoadState would restore
+
+private:
+    static const int FrameCycles = 70224; // Samples are finished at least this often
+    static const int SequencerCycles = 8192; // The frame sequencer runs at 512Hz
+    static const int BlockSamples = 512; // Most samples moved from the blip buffers to the resampler at once
+    static const int Volume = 64; // Output of a channel at full volume and full master volume is 15 * 8 * Volume
+
+    static void Init(); // Builds the tables shared by every APU
+
+    struct Channel
+    {
+        bool enabled;
+        bool dacEnabled;
+        int length; // Ticks of the length counter left
+        bool lengthEnabled;
+        int frequency; // 11 bit period value
+        int timer; // Cycles until the waveform next steps
+        int position; // Step in the duty cycle, wave table or noise shift register's output
+
+        int volume;
+        int envelopeTimer;
+
+        int duty; // Square channels
+
+        bool sweepEnabled; // Channel 1
+        int sweepShadow;
+        int sweepTimer;
+
+        uint8_t waveSample; // Channel 3, the last sample read from wave RAM
+
+        uint16_t lfsr; // Channel 4
+    };
+
+    Channel channels[4];
+    uint8_t registers[0x30]; // 0xFF10-0xFF3F as written, including wave RAM at 0xFF30
+    bool power;
+    bool silent;
+    std::vector<StereoSample>* tap;
+
+    uint32_t time; // Cycles since the start of the frame
+    uint32_t runTime; // Cycles the channels have been run up to
+    int sequencerTimer;
+    int sequencerStep;
+
+    int sampleRate;
+    int outputLeft[4]; // Each channel's current contribution to the blip buffers
+    int outputRight[4];
+    BlipBuffer left;
+    BlipBuffer right;
+    Resampler resampler;
+
+    uint8_t readValue; // What GetMemoryPtr points at for reads
+
+    void Run(uint32_t until);
+    void EndFrame();
+
+    void RunSquare(int index, uint32_t start, uint32_t end);
+    void RunWave(uint32_t start, uint32_t end);
+    void RunNoise(uint32_t start, uint32_t end);
+    void ClockSequencer();
+
+    void Trigger(int index);
+    int SweepFrequency(); // The next frequency of the sweep, over 2047 disables the channel
+    int Period(int index); // Cycles between steps of the waveform
+    bool IsAudible(int index);
+
+    void UpdateOutput(int index, uint32_t at);
+    void UpdateAllOutputs(uint32_t at);
+
+    uint8_t& Register(IORegisters reg);
+};
+
+#endif // APU_H
@@ -0,0 +1,147 @@
+#include "AudioOutput.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+constexpr double AudioOutput::MaxRateAdjustment;
+
+// A fifth of a second at 48kHz, plenty to cover the emulation running unevenly
+static const int QueueSamples = 9600;
+
+AudioOutput::AudioOutput() : queue(QueueSamples)
+{
+    device = 0;
+    sampleRate = 0;
+    latency = QueueSamples;
+    lastSample.left = 0;
+    lastSample.right = 0;
+    underruns = 0;
+    dropped = 0;
+}
+
+AudioOutput::~AudioOutput()
+{
+    Close();
+}
+
+bool AudioOutput::Open(int sampleRate, int bufferSamples)
+{
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
+    {
+        cout << "SDL audio could not initialize! SDL_Error: " << SDL_GetError() << endl;
+        return false;
+    }
+
+    SDL_AudioSpec wanted;
+    SDL_AudioSpec obtained;
+    SDL_memset(&wanted, 0, sizeof(wanted));
+    wanted.freq = sampleRate;
+    wanted.format = AUDIO_S16SYS;
+    wanted.channels = 2;
+    wanted.samples = bufferSamples;
+    wanted.callback = AudioCallback;
+    wanted.userdata = this;
+
+    // Only the rate may differ, the APU can generate samples at any rate
+    device = SDL_OpenAudioDevice(NULL, 0, &wanted, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (device == 0)
+    {
+        cout << "Audio device could not be opened! SDL_Error: " << SDL_GetError() << endl;
+        return false;
+    }
+
+    this->sampleRate = obtained.freq;
+    SDL_PauseAudioDevice(device, 0);
+    return true;
+}
+
+void AudioOutput::Close()
+{
+    if (device != 0)
+    {
+        SDL_CloseAudioDevice(device);
+        device = 0;
+    }
+}
+
+void AudioOutput::SetLatency(int samples)
+{
+    latency = min(max(samples, 1), QueueSamples);
+}
+
+void AudioOutput::Write(const StereoSample* samples, int count, bool wait)
+{
+    while (count > 0)
+    {
+        int space = latency - (int)queue.Count();
+        int written = space > 0 ? queue.Write(samples, min(count, space)) : 0;
+        samples += written;
+        count -= written;
+
+        if (count > 0 && !wait)
+        {
+            dropped += count;
+            return;
+        }
+        if (count > 0)
+        {
+            // The callback takes a buffer's worth at a time, so there's no point checking more often
+            this_thread::sleep_for(chrono::microseconds(500));
+        }
+    }
+}
+
+double AudioOutput::GetRateAdjustment()
+{
+    double fill = (double)queue.Count() / latency;
+    return 1.0 + MaxRateAdjustment * (1.0 - 2.0 * min(fill, 1.0));
+}
+
+int AudioOutput::GetSampleRate()
+{
+    return sampleRate;
+}
+
+int AudioOutput::GetQueued()
+{
+    return queue.Count();
+}
+
+uint32_t AudioOutput::GetUnderruns()
+{
+    return underruns;
+}
+
+uint32_t AudioOutput::GetDropped()
+{
+    return dropped;
+}
+
+/** @brief Called by SDL on its audio thread to fill the device's buffer
+ *
+ * @return void
+ *
+ */
+void AudioOutput::AudioCallback(void* userdata, Uint8* stream, int length)
+{
+    AudioOutput* output = (AudioOutput*)userdata;
+    StereoSample* samples = (StereoSample*)stream;
+    int count = length / sizeof(StereoSample);
+
+    int read = output->queue.Read(samples, count);
+    if (read > 0)
+    {
+        output->lastSample = samples[read - 1];
+    }
+    if (read < count)
+    {
+        output->underruns++;
+        for (int i = read; i < count; i++)
+        {
+            samples[i] = output->lastSample;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <SDL.h>
+#include <stdint.h>
+#include <atomic>
+#include "Audio/APU.h"
+#include "Util/RingBuffer.h"
+
+/** @brief Plays the APU's samples through an SDL audio device
+ * Samples are passed to SDL's audio callback through a lock free queue, so the audio thread
+ * never waits for the emulation thread. If the queue runs dry the callback repeats the last
+ * sample instead of clicking. Samples that don't fit are dropped, or with audio sync, Write
+ * waits for room so emulation can't get ahead of the sound.
+ */
+class AudioOutput
+{
+public:
+    AudioOutput();
+    virtual ~AudioOutput();
+
+    /** @brief Opens the default audio device for 16 bit stereo and starts playing
+     *
+     * @param sampleRate int Requested rate, the device may pick another (see GetSampleRate)
+     * @param bufferSamples int Samples SDL asks for at a time, smaller is lower latency
+     * @return false if there's no audio device
+     *
+     */
+    bool Open(int sampleRate, int bufferSamples);
+    void Close();
+
+    static constexpr double MaxRateAdjustment = 0.005; // Furthest GetRateAdjustment strays from 1, too little to hear
+
+    void SetLatency(int samples); // Most samples queued at once, the rest of the queue goes unused
+    void Write(const StereoSample* samples, int count, bool wait); // wait = block until there's room instead of dropping
+
+    /** @brief Dynamic rate control, how much faster or slower the APU should generate samples
+     * Proportional to how far the queue is from half full: a queue filling up needs fewer
+     * samples and a draining one needs more. Applied every frame, this keeps the queue near half
+     * full with no audible pitch change as long as the device's clock is within 0.5% of the
+     * one pacing emulation, so it neither runs dry nor blocks and the latency can be kept small.
+     *
+     * @return double Ratio for APU::SetRateAdjustment
+     *
+     */
+    double GetRateAdjustment();
+
+    int GetSampleRate();
+    int GetQueued(); // Samples waiting to be played
+    uint32_t GetUnderruns(); // Times the callback ran out of samples
+    uint32_t GetDropped(); // Samples that didn't fit in the queue
+
+private:
+    SDL_AudioDeviceID device;
+    int sampleRate;
+    int latency;
+
+    RingBuffer<StereoSample> queue;
+    StereoSample lastSample; // Only used by the callback
+
+    std::atomic<uint32_t> underruns;
+    uint32_t dropped;
+
+    static void AudioCallback(void* userdata, Uint8* stream, int length);
+};
+
+#endif // AUDIOOUTPUT_H
@@ -0,0 +1,146 @@
+#include "BlipBuffer.h"
+
+#include <math.h>
+#include <string.h>
+
+static const double Pi = 3.14159265358979323846;
+
+int16_t BlipBuffer::kernel[BlipBuffer::Phases][BlipBuffer::Width];
+
+BlipBuffer::BlipBuffer()
+{
+    static bool initialised = (BuildKernel(), true);
+    (void)initialised;
+
+    SetRates(4194304.0, 48000.0);
+}
+
+BlipBuffer::~BlipBuffer()
+{
+}
+
+/** @brief Sets the input clock rate and the output sample rate, and clears the buffer
+ * The buffer holds a quarter of a second of samples.
+ *
+ * @return void
+ *
+ */
+void BlipBuffer::SetRates(double clockRate, double sampleRate)
+{
+    factor = (uint64_t)(sampleRate / clockRate * 4294967296.0 + 0.5);
+    buffer.assign((int)sampleRate / 4 + Width, 0);
+    Clear();
+}
+
+void BlipBuffer::Clear()
+{
+    offset = 0;
+    integrator = 0;
+    memset(buffer.data(), 0, buffer.size() * sizeof(int32_t));
+}
+
+/** @brief Builds the band limited steps, one for each phase
+ * Each is a Blackman windowed sinc cut off a little below half the sample rate, centred
+ * between taps HalfWidth - 1 and HalfWidth. Every phase is scaled to add up to exactly
+ * 1 << KernelBits so the running sum never drifts.
+ *
+ * @return void
+ *
+ */
+void BlipBuffer::BuildKernel()
+{
+    const double Cutoff = 0.9;
+
+    for (int phase = 0; phase < Phases; phase++)
+    {
+        double taps[Width];
+        double sum = 0.0;
+        for (int i = 0; i < Width; i++)
+        {
+            double x = i - (HalfWidth - 1) - (double)phase / Phases;
+            double sinc = x == 0.0 ? 1.0 : sin(Pi * x * Cutoff) / (Pi * x * Cutoff);
+            double window = 0.42 + 0.5 * cos(Pi * x / HalfWidth) + 0.08 * cos(2.0 * Pi * x / HalfWidth);
+            taps[i] = sinc * window;
+            sum += taps[i];
+        }
+
+        int total = 0;
+        for (int i = 0; i < Width; i++)
+        {
+            kernel[phase][i] = (int16_t)floor(taps[i] / sum * (1 << KernelBits) + 0.5);
+            total += kernel[phase][i];
+        }
+        // Put the rounding error in the biggest tap
+        kernel[phase][HalfWidth - 1 + (phase >= Phases / 2)] += (1 << KernelBits) - total;
+    }
+}
+
+void BlipBuffer::AddDelta(uint32_t time, int delta)
+{
+    uint64_t position = offset + time * factor;
+    size_t index = position >> 32;
+    int phase = (position >> (32 - PhaseBits)) & (Phases - 1);
+
+    // Only happens if nobody reads the samples, which the APU makes sure of
+    if (index + Width > buffer.size())
+    {
+        return;
+    }
+
+    int32_t* out = &buffer[index];
+    const int16_t* step = kernel[phase];
+    for (int i = 0; i < Width; i++)
+    {
+        out[i] += step[i] * delta;
+    }
+}
+
+void BlipBuffer::EndFrame(uint32_t time)
+{
+    offset += time * factor;
+
+    uint64_t limit = (uint64_t)(buffer.size() - Width) << 32;
+    if (offset > limit)
+    {
+        offset = limit;
+    }
+}
+
+int BlipBuffer::SamplesAvailable()
+{
+    return offset >> 32;
+}
+
+int BlipBuffer::ReadSamples(int16_t* out, int count, int stride)
+{
+    int available = SamplesAvailable();
+    if (count > available)
+    {
+        count = available;
+    }
+
+    int32_t sum = integrator;
+    for (int i = 0; i < count; i++)
+    {
+        sum += buffer[i];
+        int sample = sum >> KernelBits;
+        if (sample > 32767)
+            sample = 32767;
+        else if (sample < -32768)
+            sample = -32768;
+        if (out != NULL)
+        {
+            out[i * stride] = sample;
+        }
+        // High pass, removes the DC offset of the channels' all positive output
+        sum -= sum >> 9;
+    }
+    integrator = sum;
+
+    // Move the samples still being built to the start
+    int remaining = available - count + Width;
+    memmove(buffer.data(), buffer.data() + count, remaining * sizeof(int32_t));
+    memset(buffer.data() + remaining, 0, count * sizeof(int32_t));
+    offset -= (uint64_t)count << 32;
+    return count;
+}
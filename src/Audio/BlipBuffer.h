@@ -0,0 +1,55 @@
+#ifndef BLIPBUFFER_H
+#define BLIPBUFFER_H
+
+#include <stdint.h>
+#include <vector>
+
+/** @brief Turns amplitude changes at clock times into band limited samples
+ * Instead of generating every sample, the APU only tells the buffer when and by how much its
+ * output changes. Each change adds a band limited step (a windowed sinc, picked for where the
+ * change falls between two samples) and the output is the running sum of the steps. This makes
+ * the cost depend on how often the waveforms change rather than on the output sample rate,
+ * and the result has no aliasing however high the channels' frequencies are.
+ */
+class BlipBuffer
+{
+public:
+    BlipBuffer();
+    virtual ~BlipBuffer();
+
+    static const int KernelBits = 15; // A step of 1 adds up to 1 << KernelBits in the buffer
+
+    void SetRates(double clockRate, double sampleRate);
+    void Clear();
+
+    void AddDelta(uint32_t time, int delta); // time in clocks since the start of the frame
+    void EndFrame(uint32_t time); // Samples up to time can be read, and time becomes the start of the next frame
+
+    int SamplesAvailable();
+
+    /** @brief Reads finished samples out of the buffer
+     *
+     * @param out int16_t* NULL to throw the samples away
+     * @param count int
+     * @param stride int Distance between samples in out, 2 to interleave stereo
+     * @return The number of samples read
+     *
+     */
+    int ReadSamples(int16_t* out, int count, int stride);
+
+private:
+    static const int PhaseBits = 5;
+    static const int Phases = 1 << PhaseBits; // Positions between two samples a step can start at
+    static const int HalfWidth = 8;
+    static const int Width = HalfWidth * 2; // Samples each step is spread over
+
+    static int16_t kernel[Phases][Width];
+    static void BuildKernel();
+
+    uint64_t factor; // Samples per clock, 32.32 fixed point
+    uint64_t offset; // Sample position of the start of the frame, 32.32 fixed point
+    int32_t integrator; // Running sum of the steps, carried over between reads
+    std::vector<int32_t> buffer;
+};
+
+#endif // BLIPBUFFER_H
@@ -0,0 +1,328 @@
+#include "Resampler.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define RESAMPLER_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static const double Pi = 3.14159265358979323846;
+
+Resampler::DotFunc Resampler::dot = NULL;
+const char* Resampler::kernelName = "";
+
+static void DotScalar(const float* frames, const float* phase0, const float* phase1, int taps, float* out)
+{
+    float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < taps * 2; i += 2)
+    {
+        sums[0] += frames[i] * phase0[i];
+        sums[1] += frames[i + 1] * phase0[i + 1];
+        sums[2] += frames[i] * phase1[i];
+        sums[3] += frames[i + 1] * phase1[i + 1];
+    }
+    memcpy(out, sums, sizeof(sums));
+}
+
+#ifdef RESAMPLER_X86
+// acc0 and acc1 each hold left, right, left, right partial sums
+__attribute__((target("sse")))
+static inline void StoreSums(__m128 acc0, __m128 acc1, float* out)
+{
+    _mm_storeu_ps(out, _mm_add_ps(_mm_movelh_ps(acc0, acc1), _mm_movehl_ps(acc1, acc0)));
+}
+
+// Two frames at a time, taps is always a multiple of 8
+__attribute__((target("sse")))
+static void DotSSE(const float* frames, const float* phase0, const float* phase1, int taps, float* out)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (int i = 0; i < taps * 2; i += 4)
+    {
+        __m128 f = _mm_loadu_ps(frames + i);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(f, _mm_loadu_ps(phase0 + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(f, _mm_loadu_ps(phase1 + i)));
+    }
+    StoreSums(acc0, acc1, out);
+}
+
+// Four frames at a time
+__attribute__((target("avx")))
+static void DotAVX(const float* frames, const float* phase0, const float* phase1, int taps, float* out)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (int i = 0; i < taps * 2; i += 8)
+    {
+        __m256 f = _mm256_loadu_ps(frames + i);
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(f, _mm256_loadu_ps(phase0 + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(f, _mm256_loadu_ps(phase1 + i)));
+    }
+    StoreSums(_mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1)),
+              _mm_add_ps(_mm256_castps256_ps128(acc1), _mm256_extractf128_ps(acc1, 1)), out);
+}
+#endif
+
+Resampler::Resampler()
+{
+    static bool initialised = (Init(), true);
+    (void)initialised;
+
+    Configure(65536.0, 48000.0, ResamplerQuality::High);
+}
+
+Resampler::~Resampler()
+{
+}
+
+void Resampler::Init()
+{
+    dot = DotScalar;
+    kernelName = "scalar";
+
+#ifdef RESAMPLER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+    {
+        dot = DotAVX;
+        kernelName = "AVX";
+    }
+    else if (__builtin_cpu_supports("sse"))
+    {
+        dot = DotSSE;
+        kernelName = "SSE";
+    }
+#endif
+}
+
+void Resampler::Configure(double inputRate, double outputRate, ResamplerQuality quality)
+{
+    this->inputRate = inputRate;
+    this->outputRate = outputRate;
+    this->quality = quality;
+
+    switch (quality)
+    {
+    case ResamplerQuality::Linear:
+        taps = 2;
+        break;
+    case ResamplerQuality::Low:
+        taps = 16;
+        break;
+    case ResamplerQuality::Medium:
+        taps = 32;
+        break;
+    case ResamplerQuality::High:
+        taps = 64;
+        break;
+    }
+
+    BuildKernel();
+    SetRateAdjustment(1.0);
+    readSeconds = 0.0;
+    inputTotal = 0;
+    Clear();
+}
+
+void Resampler::SetRateAdjustment(double ratio)
+{
+    step = (uint64_t)(inputRate / (outputRate * ratio) * 4294967296.0 + 0.5);
+}
+
+void Resampler::Clear()
+{
+    // Start with the filter's history silent so the first samples can be read straight away
+    frameCount = taps - 1;
+    frames.assign(frameCount * 2, 0.0f);
+    position = 0;
+}
+
+// Modified Bessel function of the first kind, for the Kaiser window
+static double BesselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/** @brief Tabulates the filter for each phase
+ * Phase p is the sinc centred p / Phases of the way from tap taps / 2 - 1 to the next tap, so
+ * phase Phases is phase 0 moved along a tap, there to interpolate towards. Sharper filters are
+ * cut off closer to Nyquist and use a stronger window to keep the stop band low. Every phase is
+ * scaled to add up to 1 so there's no ripple at DC.
+ *
+ * @return void
+ *
+ */
+void Resampler::BuildKernel()
+{
+    kernel.clear();
+    if (quality == ResamplerQuality::Linear)
+    {
+        return;
+    }
+
+    double rolloff = quality == ResamplerQuality::Low ? 0.80 : quality == ResamplerQuality::Medium ? 0.88 : 0.92;
+    double beta = quality == ResamplerQuality::Low ? 6.0 : quality == ResamplerQuality::Medium ? 8.0 : 10.0;
+    // Cycles per input sample, below the output's Nyquist frequency when downsampling
+    double cutoff = 0.5 * min(1.0, outputRate / inputRate) * rolloff;
+    double half = taps / 2;
+
+    kernel.assign((Phases + 1) * taps * 2, 0.0f);
+    vector<double> phase(taps);
+    for (int p = 0; p <= Phases; p++)
+    {
+        double sum = 0.0;
+        for (int i = 0; i < taps; i++)
+        {
+            double x = i - (half - 1) - (double)p / Phases;
+            double sinc = x == 0.0 ? 1.0 : sin(2.0 * Pi * cutoff * x) / (2.0 * Pi * cutoff * x);
+            double window = fabs(x) >= half ? 0.0 : BesselI0(beta * sqrt(1.0 - (x / half) * (x / half))) / BesselI0(beta);
+            phase[i] = sinc * window;
+            sum += phase[i];
+        }
+
+        float* out = &kernel[p * taps * 2];
+        for (int i = 0; i < taps; i++)
+        {
+            out[i * 2] = out[i * 2 + 1] = (float)(phase[i] / sum);
+        }
+    }
+}
+
+void Resampler::Write(const StereoSample* samples, int count)
+{
+    if ((int)frames.size() < (frameCount + count) * 2)
+    {
+        frames.resize((frameCount + count) * 2);
+    }
+
+    float* out = &frames[frameCount * 2];
+    for (int i = 0; i < count; i++)
+    {
+        out[i * 2] = samples[i].left;
+        out[i * 2 + 1] = samples[i].right;
+    }
+    frameCount += count;
+    inputTotal += count;
+}
+
+static inline int16_t Clamp(float sample)
+{
+    int value = (int)lrintf(sample);
+    return value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+}
+
+int Resampler::Read(StereoSample* out, int count)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    int read = 0;
+    while (read < count)
+    {
+        int index = position >> 32;
+        if (index + taps > frameCount)
+        {
+            break;
+        }
+
+        uint32_t fraction = (uint32_t)position;
+        const float* in = &frames[index * 2];
+        if (quality == ResamplerQuality::Linear)
+        {
+            float t = fraction * (1.0f / 4294967296.0f);
+            out[read].left = Clamp(in[0] + (in[2] - in[0]) * t);
+            out[read].right = Clamp(in[1] + (in[3] - in[1]) * t);
+        }
+        else
+        {
+            int p = fraction >> (32 - PhaseBits);
+            float t = (fraction << PhaseBits) * (1.0f / 4294967296.0f);
+            float sums[4];
+            dot(in, &kernel[p * taps * 2], &kernel[(p + 1) * taps * 2], taps, sums);
+            out[read].left = Clamp(sums[0] + (sums[2] - sums[0]) * t);
+            out[read].right = Clamp(sums[1] + (sums[3] - sums[1]) * t);
+        }
+
+        position += step;
+        read++;
+    }
+
+    // Drop the frames no output sample needs any more
+    int used = min((int)(position >> 32), frameCount);
+    memmove(frames.data(), frames.data() + used * 2, (frameCount - used) * 2 * sizeof(float));
+    frameCount -= used;
+    position -= (uint64_t)used << 32;
+
+    readSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return read;
+}
+
+int Resampler::InputNeeded(int outputCount)
+{
+    if (outputCount <= 0)
+    {
+        return 0;
+    }
+    uint64_t last = position + (uint64_t)(outputCount - 1) * step;
+    return max((int)(last >> 32) + taps - frameCount, 0);
+}
+
+ResamplerQuality Resampler::GetQuality()
+{
+    return quality;
+}
+
+const char* Resampler::GetName()
+{
+    return quality == ResamplerQuality::Linear ? "scalar" : kernelName;
+}
+
+/** @brief Switches the dot products to the named version, so tests can check they all agree.
+ * They're shared by every Resampler.
+ *
+ * @param version const char* "scalar", "SSE" or "AVX"
+ * @return false if the CPU can't run it, leaving the version as it was
+ *
+ */
+bool Resampler::UseVersion(const char* version)
+{
+    if (strcmp(version, "scalar") == 0)
+    {
+        dot = DotScalar;
+        kernelName = "scalar";
+        return true;
+    }
+#ifdef RESAMPLER_X86
+    if (strcmp(version, "SSE") == 0 && __builtin_cpu_supports("sse"))
+    {
+        dot = DotSSE;
+        kernelName = "SSE";
+        return true;
+    }
+    if (strcmp(version, "AVX") == 0 && __builtin_cpu_supports("avx"))
+    {
+        dot = DotAVX;
+        kernelName = "AVX";
+        return true;
+    }
+#endif
+    return false;
+}
+
+double Resampler::GetCost()
+{
+    return inputTotal == 0 ? 0.0 : readSeconds / (inputTotal / inputRate);
+}
@@ -0,0 +1,85 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+#include <vector>
+
+struct StereoSample
+{
+    int16_t left;
+    int16_t right;
+};
+
+enum class ResamplerQuality
+{
+    Linear, // Interpolates between two samples, cheap but lets some aliasing through
+    Low, // 16 tap windowed sinc
+    Medium, // 32 taps
+    High, // 64 taps
+};
+
+/** @brief Converts stereo samples from one rate to another
+ * The sinc qualities are polyphase filters: a Kaiser windowed sinc, cut off below the lower of
+ * the two Nyquist frequencies, is tabulated at Phases positions between two input samples, and
+ * each output sample is the dot product of the input around it with the two nearest phases,
+ * interpolated. The dot products have SSE and AVX versions, picked the first time a Resampler
+ * is created when the CPU supports them.
+ */
+class Resampler
+{
+public:
+    Resampler();
+    virtual ~Resampler();
+
+    /** @brief Sets the rates and the filter, and clears the samples waiting
+     *
+     * @param inputRate double
+     * @param outputRate double
+     * @param quality ResamplerQuality
+     * @return void
+     *
+     */
+    void Configure(double inputRate, double outputRate, ResamplerQuality quality);
+    void SetRateAdjustment(double ratio); // Scales the output rate without clearing or changing the filter
+    void Clear();
+
+    void Write(const StereoSample* samples, int count);
+    int Read(StereoSample* out, int count); // Returns the samples read, as many as the input written so far allows
+    int InputNeeded(int outputCount); // Input samples to write before outputCount samples can be read
+
+    ResamplerQuality GetQuality();
+    const char* GetName(); // Name of the kernel version in use
+    bool UseVersion(const char* version); // Switches every Resampler to a version by name for tests, false if the CPU can't run it
+    double GetCost(); // Seconds spent in Read per second of input resampled
+
+private:
+    static const int PhaseBits = 7;
+    static const int Phases = 1 << PhaseBits;
+
+    // Dot products of two interleaved stereo frames with two phases of the filter, which are
+    // stored with each tap twice to match. out gets the left and right sums for each phase.
+    typedef void (*DotFunc)(const float* frames, const float* phase0, const float* phase1, int taps, float* out);
+
+    static DotFunc dot;
+    static const char* kernelName;
+
+    static void Init();
+
+    double inputRate;
+    double outputRate;
+    ResamplerQuality quality;
+    int taps;
+
+    std::vector<float> kernel; // Phases + 1 phases of taps * 2 coefficients
+    std::vector<float> frames; // Input still needed, left and right interleaved
+    int frameCount;
+    uint64_t step; // Input frames per output sample, 32.32 fixed point
+    uint64_t position; // Of the next output sample in frames, 32.32 fixed point
+
+    double readSeconds;
+    uint64_t inputTotal;
+
+    void BuildKernel();
+};
+
+#endif // RESAMPLER_H
@@ -0,0 +1,180 @@
+#include "AudioRecorder.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+
+static const size_t FileBufferSize = 1024 * 1024;
+
+AudioRecorder::AudioRecorder() : queue(QueueSamples)
+{
+    file = NULL;
+    fileBuffer = NULL;
+    sampleRate = 0;
+    running = false;
+    samplesWritten = 0;
+    stalls = 0;
+    failed = false;
+}
+
+AudioRecorder::~AudioRecorder()
+{
+    Close();
+}
+
+bool AudioRecorder::Open(const char* path, int sampleRate)
+{
+    file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        cout << "Couldn't create " << path << endl;
+        return false;
+    }
+
+    fileBuffer = new char[FileBufferSize];
+    setvbuf(file, fileBuffer, _IOFBF, FileBufferSize);
+
+    this->sampleRate = sampleRate;
+    failed = !WriteHeader(0);
+
+    running = true;
+    writerThread = thread(&AudioRecorder::WriterLoop, this);
+    return true;
+}
+
+void AudioRecorder::Close()
+{
+    if (writerThread.joinable())
+    {
+        running = false;
+        sampleSignal.notify_one();
+        writerThread.join();
+    }
+
+    if (file != NULL)
+    {
+        if (fseek(file, 0, SEEK_SET) != 0 || !WriteHeader(samplesWritten * sizeof(StereoSample)))
+        {
+            failed = true;
+        }
+        if (fclose(file) != 0)
+        {
+            failed = true;
+        }
+        file = NULL;
+    }
+    delete[] fileBuffer;
+    fileBuffer = NULL;
+}
+
+void AudioRecorder::PushSamples(const StereoSample* samples, int count)
+{
+    int written = queue.Write(samples, count);
+    if (written < count)
+    {
+        // The disk has fallen a long way behind, wait for it rather than lose samples
+        stalls++;
+        while (written < count)
+        {
+            sampleSignal.notify_one();
+            this_thread::sleep_for(chrono::milliseconds(1));
+            written += queue.Write(samples + written, count - written);
+        }
+    }
+    sampleSignal.notify_one();
+}
+
+uint32_t AudioRecorder::GetSamplesWritten()
+{
+    return samplesWritten;
+}
+
+uint32_t AudioRecorder::GetStalls()
+{
+    return stalls;
+}
+
+bool AudioRecorder::HasFailed()
+{
+    return failed;
+}
+
+/** @brief Writer thread, writes queued samples until the recorder is closed and the queue is empty
+ *
+ * @return void
+ *
+ */
+void AudioRecorder::WriterLoop()
+{
+    while (true)
+    {
+        // Checked before the queue, so every sample pushed before Close is seen before stopping
+        bool stopping = !running;
+
+        int count = queue.Read(block, BlockSamples);
+        if (count > 0)
+        {
+            // WAV is little endian, like every machine this runs on. After a failed write the
+            // queue is still emptied, so PushSamples never waits on a disk that's given up.
+            if (!failed)
+            {
+                size_t written = fwrite(block, sizeof(StereoSample), count, file);
+                samplesWritten += written;
+                failed = written != (size_t)count;
+            }
+            continue;
+        }
+
+        if (stopping)
+        {
+            break;
+        }
+
+        // PushSamples doesn't take the lock, so a missed notify is covered by the timeout
+        unique_lock<mutex> lock(signalMutex);
+        sampleSignal.wait_for(lock, chrono::milliseconds(10));
+    }
+
+    if (fflush(file) != 0)
+    {
+        failed = true;
+    }
+}
+
+static void Write16(uint8_t* out, uint16_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static void Write32(uint8_t* out, uint32_t value)
+{
+    Write16(out, value & 0xFFFF);
+    Write16(out + 2, value >> 16);
+}
+
+/** @brief Writes a canonical 44 byte PCM WAV header
+ *
+ * @param dataSize uint32_t Bytes of samples following the header
+ * @return false if it couldn't be written
+ *
+ */
+bool AudioRecorder::WriteHeader(uint32_t dataSize)
+{
+    uint8_t header[HeaderSize];
+    memcpy(header, "RIFF", 4);
+    Write32(header + 4, HeaderSize - 8 + dataSize);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    Write32(header + 16, 16); // Size of the fmt chunk
+    Write16(header + 20, 1); // PCM
+    Write16(header + 22, 2); // Channels
+    Write32(header + 24, sampleRate);
+    Write32(header + 28, sampleRate * sizeof(StereoSample)); // Bytes per second
+    Write16(header + 32, sizeof(StereoSample)); // Bytes per sample for all channels
+    Write16(header + 34, 16); // Bits per channel
+    memcpy(header + 36, "data", 4);
+    Write32(header + 40, dataSize);
+    return fwrite(header, 1, HeaderSize, file) == HeaderSize;
+}
@@ -0,0 +1,59 @@
+#ifndef AUDIORECORDER_H
+#define AUDIORECORDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Audio/Resampler.h"
+#include "Util/RingBuffer.h"
+
+/** @brief Records the APU's samples to a 16 bit stereo WAV file on a writer thread
+ * Works the same way as VideoRecorder: samples are copied into a queue and the writer thread
+ * writes them out in large blocks. The header's sizes aren't known until the end, so they're
+ * written as 0 and filled in by Close. Nothing here needs an audio device.
+ */
+class AudioRecorder
+{
+public:
+    AudioRecorder();
+    virtual ~AudioRecorder();
+
+    static const int QueueSamples = 4 * 48000; // ~4 seconds
+
+    bool Open(const char* path, int sampleRate); // Returns false if the file couldn't be created
+    void Close(); // Writes out every queued sample and the final header
+
+    void PushSamples(const StereoSample* samples, int count);
+
+    uint32_t GetSamplesWritten();
+    uint32_t GetStalls(); // Times PushSamples had to wait for the writer
+    bool HasFailed(); // A write failed, so the file is missing samples or has the wrong sizes
+
+private:
+    static const int HeaderSize = 44;
+    static const int BlockSamples = 8192; // Most samples the writer takes from the queue at once
+
+    FILE* file;
+    char* fileBuffer;
+    int sampleRate;
+
+    RingBuffer<StereoSample> queue;
+    StereoSample block[BlockSamples];
+
+    std::thread writerThread;
+    std::atomic<bool> running;
+    std::mutex signalMutex;
+    std::condition_variable sampleSignal;
+
+    std::atomic<uint32_t> samplesWritten;
+    uint32_t stalls;
+    std::atomic<bool> failed;
+
+    void WriterLoop();
+    bool WriteHeader(uint32_t dataSize);
+};
+
+#endif // AUDIORECORDER_H
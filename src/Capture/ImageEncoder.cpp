@@ -0,0 +1,321 @@
+#include "ImageEncoder.h"
+
+#include <string.h>
+#include <algorithm>
+
+using namespace std;
+
+static void Write32BE(vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back(value >> 24);
+    out.push_back(value >> 16 & 0xFF);
+    out.push_back(value >> 8 & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+void ImageEncoder::Encode(ImageFormat format, const uint32_t* pixels, int width, int height, vector<uint8_t>& out)
+{
+    if (format == ImageFormat::QOI)
+    {
+        EncodeQOI(pixels, width, height, out);
+    }
+    else
+    {
+        EncodePNG(pixels, width, height, out);
+    }
+}
+
+void ImageEncoder::EncodeQOI(const uint32_t* pixels, int width, int height, vector<uint8_t>& out)
+{
+    const uint8_t OpIndex = 0x00, OpDiff = 0x40, OpLuma = 0x80, OpRun = 0xC0, OpRGB = 0xFE;
+
+    out.clear();
+    out.reserve(14 + width * height * 4 + 8);
+    out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+    Write32BE(out, width);
+    Write32BE(out, height);
+    out.push_back(3); // RGB
+    out.push_back(0); // sRGB
+
+    // Every pixel is opaque, so alpha is always 255 and is left out of the comparisons
+    uint32_t index[64];
+    memset(index, 0, sizeof(index));
+    uint32_t previous = 0x000000;
+    int run = 0;
+    int count = width * height;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t pixel = pixels[i] & 0xFFFFFF;
+
+        if (pixel == previous)
+        {
+            run++;
+            if (run == 62 || i == count - 1)
+            {
+                out.push_back(OpRun | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run > 0)
+        {
+            out.push_back(OpRun | (run - 1));
+            run = 0;
+        }
+
+        int r = pixel >> 16, g = pixel >> 8 & 0xFF, b = pixel & 0xFF;
+        int hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+
+        if (index[hash] == (pixel | 0xFF000000))
+        {
+            out.push_back(OpIndex | hash);
+        }
+        else
+        {
+            index[hash] = pixel | 0xFF000000;
+
+            int8_t dr = r - (int)(previous >> 16);
+            int8_t dg = g - (int)(previous >> 8 & 0xFF);
+            int8_t db = b - (int)(previous & 0xFF);
+            int8_t drg = dr - dg;
+            int8_t dbg = db - dg;
+
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+            {
+                out.push_back(OpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+            }
+            else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+            {
+                out.push_back(OpLuma | (dg + 32));
+                out.push_back((drg + 8) << 4 | (dbg + 8));
+            }
+            else
+            {
+                out.insert(out.end(), { OpRGB, (uint8_t)r, (uint8_t)g, (uint8_t)b });
+            }
+        }
+
+        previous = pixel;
+    }
+
+    out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+}
+
+static uint32_t crcTable[256];
+
+static uint32_t Crc32(const uint8_t* data, size_t length, uint32_t crc = 0)
+{
+    static bool initialised = []
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            crcTable[i] = c;
+        }
+        return true;
+    }();
+    (void)initialised;
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void ImageEncoder::WritePNGChunk(vector<uint8_t>& out, const char* type, const uint8_t* data, size_t length)
+{
+    Write32BE(out, length);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + length);
+    Write32BE(out, Crc32(&out[start], length + 4));
+}
+
+void ImageEncoder::EncodePNG(const uint32_t* pixels, int width, int height, vector<uint8_t>& out)
+{
+    // Each row is a filter type byte (0, none) followed by the RGB pixels
+    int rowSize = 1 + width * 3;
+    vector<uint8_t> raw(rowSize * height);
+    for (int y = 0; y < height; y++)
+    {
+        uint8_t* row = &raw[y * rowSize];
+        row[0] = 0;
+        for (int x = 0; x < width; x++)
+        {
+            uint32_t pixel = pixels[y * width + x];
+            row[1 + x * 3] = pixel >> 16 & 0xFF;
+            row[2 + x * 3] = pixel >> 8 & 0xFF;
+            row[3 + x * 3] = pixel & 0xFF;
+        }
+    }
+
+    vector<uint8_t> compressed;
+    Deflate(raw.data(), raw.size(), compressed);
+
+    out.clear();
+    const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.insert(out.end(), signature, signature + sizeof(signature));
+
+    vector<uint8_t> header;
+    Write32BE(header, width);
+    Write32BE(header, height);
+    header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8 bit RGB, no interlacing
+    WritePNGChunk(out, "IHDR", header.data(), header.size());
+    WritePNGChunk(out, "IDAT", compressed.data(), compressed.size());
+    WritePNGChunk(out, "IEND", NULL, 0);
+}
+
+// Writes deflate's bit stream, which fills each byte from its lowest bit
+struct BitWriter
+{
+    vector<uint8_t>& out;
+    uint32_t bits;
+    int count;
+
+    BitWriter(vector<uint8_t>& out) : out(out), bits(0), count(0) {}
+
+    void Write(uint32_t value, int length)
+    {
+        bits |= value << count;
+        count += length;
+        while (count >= 8)
+        {
+            out.push_back(bits & 0xFF);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes are stored starting from their most significant bit
+    void WriteCode(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++)
+        {
+            reversed = reversed << 1 | (code >> i & 1);
+        }
+        Write(reversed, length);
+    }
+
+    void Flush()
+    {
+        if (count > 0)
+        {
+            out.push_back(bits & 0xFF);
+        }
+        bits = 0;
+        count = 0;
+    }
+};
+
+static const uint16_t LengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DistanceBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DistanceExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Writes a literal/length symbol with the fixed Huffman code from RFC 1951 3.2.6
+static void WriteFixedSymbol(BitWriter& writer, int symbol)
+{
+    if (symbol < 144)
+        writer.WriteCode(0x30 + symbol, 8);
+    else if (symbol < 256)
+        writer.WriteCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        writer.WriteCode(symbol - 256, 7);
+    else
+        writer.WriteCode(0xC0 + symbol - 280, 8);
+}
+
+/** @brief Compresses data into a zlib stream
+ * Matches are found with a hash of the next 3 bytes, only checking the last position each
+ * hash was seen at, and are taken greedily.
+ *
+ * @return void
+ *
+ */
+void ImageEncoder::Deflate(const uint8_t* data, size_t length, vector<uint8_t>& out)
+{
+    const int WindowSize = 32768;
+    const int HashBits = 15;
+    const int MaxMatch = 258;
+
+    out.clear();
+    out.push_back(0x78); // Deflate, 32K window
+    out.push_back(0x01); // Fastest compression, header check bits
+
+    BitWriter writer(out);
+    writer.Write(1, 1); // Final block
+    writer.Write(1, 2); // Fixed Huffman codes
+
+    vector<int32_t> head(1 << HashBits, -WindowSize - 1);
+
+    size_t pos = 0;
+    while (pos < length)
+    {
+        int matchLength = 0;
+        int matchDistance = 0;
+
+        if (pos + 3 <= length)
+        {
+            uint32_t hash = ((data[pos] << 16 | data[pos + 1] << 8 | data[pos + 2]) * 2654435761U) >> (32 - HashBits);
+            int32_t candidate = head[hash];
+            head[hash] = pos;
+
+            if ((int32_t)pos - candidate <= WindowSize)
+            {
+                int maxLength = min((size_t)MaxMatch, length - pos);
+                while (matchLength < maxLength && data[candidate + matchLength] == data[pos + matchLength])
+                {
+                    matchLength++;
+                }
+                matchDistance = pos - candidate;
+            }
+        }
+
+        if (matchLength < 3)
+        {
+            WriteFixedSymbol(writer, data[pos]);
+            pos++;
+            continue;
+        }
+
+        int code = 0;
+        while (code < 28 && LengthBase[code + 1] <= matchLength)
+        {
+            code++;
+        }
+        WriteFixedSymbol(writer, 257 + code);
+        writer.Write(matchLength - LengthBase[code], LengthExtra[code]);
+
+        code = 0;
+        while (code < 29 && DistanceBase[code + 1] <= matchDistance)
+        {
+            code++;
+        }
+        writer.WriteCode(code, 5);
+        writer.Write(matchDistance - DistanceBase[code], DistanceExtra[code]);
+
+        // Only the start of the match goes into the hash table, which keeps long runs cheap
+        pos += matchLength;
+    }
+
+    WriteFixedSymbol(writer, 256); // End of block
+    writer.Flush();
+
+    // Adler-32 of the uncompressed data
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    Write32BE(out, b << 16 | a);
+}
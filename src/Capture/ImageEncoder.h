@@ -0,0 +1,44 @@
+#ifndef IMAGEENCODER_H
+#define IMAGEENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+enum class ImageFormat
+{
+    QOI, // Fast to encode
+    PNG, // Opens anywhere
+};
+
+/** @brief Self contained lossless image encoders, so screenshots don't need an image library
+ * Both take ARGB8888 pixels and write opaque RGB images (the alpha channel is ignored).
+ */
+class ImageEncoder
+{
+public:
+    static void Encode(ImageFormat format, const uint32_t* pixels, int width, int height, std::vector<uint8_t>& out);
+
+    /** @brief Encodes an image as QOI ("Quite OK Image"), see qoiformat.org
+     *
+     * @return void
+     *
+     */
+    static void EncodeQOI(const uint32_t* pixels, int width, int height, std::vector<uint8_t>& out);
+
+    /** @brief Encodes an image as PNG
+     * The image data is compressed with a single fixed Huffman deflate block and a simple
+     * LZ77 match finder. Game Boy frames are mostly long runs of a few colours, so this gets
+     * close to zlib's sizes at a fraction of the cost.
+     *
+     * @return void
+     *
+     */
+    static void EncodePNG(const uint32_t* pixels, int width, int height, std::vector<uint8_t>& out);
+
+private:
+    static void Deflate(const uint8_t* data, size_t length, std::vector<uint8_t>& out);
+    static void WritePNGChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t length);
+};
+
+#endif // IMAGEENCODER_H
@@ -0,0 +1,145 @@
+#include "Screenshots.h"
+
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+Screenshots::Screenshots(ImageFormat format)
+{
+    this->format = format;
+    pool = NULL;
+    nextNumber = 1;
+    requested = false;
+    saved = 0;
+    failed = 0;
+}
+
+Screenshots::~Screenshots()
+{
+    delete pool;
+}
+
+string Screenshots::Capture(const uint32_t* pixels, string path)
+{
+    ImageFormat imageFormat = format;
+    size_t dot = path.find_last_of('.');
+    string extension = dot == string::npos ? "" : path.substr(dot);
+    if (extension == ".qoi")
+    {
+        imageFormat = ImageFormat::QOI;
+    }
+    else if (extension == ".png")
+    {
+        imageFormat = ImageFormat::PNG;
+    }
+    else if (path.empty())
+    {
+        path = NextPath();
+    }
+    else
+    {
+        path += format == ImageFormat::QOI ? ".qoi" : ".png";
+    }
+
+    if (pool == NULL)
+    {
+        pool = new ThreadPool(0);
+    }
+
+    // Only ever falls behind if the disk can't keep up, in which case waiting keeps memory bounded
+    pool->Wait(MaxPending - 1);
+
+    shared_ptr<vector<uint32_t>> frame = make_shared<vector<uint32_t>>(pixels, pixels + FramePixels);
+    pool->Run([this, frame, imageFormat, path] { Save(frame->data(), imageFormat, path); });
+    return path;
+}
+
+void Screenshots::Wait()
+{
+    if (pool != NULL)
+    {
+        pool->Wait();
+    }
+}
+
+void Screenshots::Request(string path)
+{
+    requested = true;
+    requestedPath = path;
+}
+
+bool Screenshots::IsRequested()
+{
+    return requested;
+}
+
+string Screenshots::CaptureRequested(const uint32_t* pixels)
+{
+    if (!requested)
+    {
+        return "";
+    }
+
+    requested = false;
+    return Capture(pixels, requestedPath);
+}
+
+uint32_t Screenshots::GetSaved()
+{
+    return saved;
+}
+
+uint32_t Screenshots::GetFailed()
+{
+    return failed;
+}
+
+/** @brief Finds the first screenshot-N name that isn't already taken
+ *
+ * @return string
+ *
+ */
+string Screenshots::NextPath()
+{
+    const char* extension = format == ImageFormat::QOI ? ".qoi" : ".png";
+
+    while (true)
+    {
+        string path = "screenshot-" + to_string(nextNumber++) + extension;
+        FILE* existing = fopen(path.c_str(), "rb");
+        if (existing == NULL)
+        {
+            return path;
+        }
+        fclose(existing);
+    }
+}
+
+/** @brief Encodes and writes a screenshot, runs on the pool
+ *
+ * @return void
+ *
+ */
+void Screenshots::Save(const uint32_t* pixels, ImageFormat imageFormat, const string& path)
+{
+    vector<uint8_t> image;
+    ImageEncoder::Encode(imageFormat, pixels, GPU::ScreenWidth, GPU::ScreenHeight, image);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == NULL || fwrite(image.data(), 1, image.size(), file) != image.size())
+    {
+        printf("Couldn't write screenshot %s\n", path.c_str());
+        failed++;
+    }
+    else
+    {
+        saved++;
+    }
+
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+}
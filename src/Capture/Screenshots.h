@@ -0,0 +1,60 @@
+#ifndef SCREENSHOTS_H
+#define SCREENSHOTS_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include "Capture/ImageEncoder.h"
+#include "GPU/GPU.h"
+#include "Util/ThreadPool.h"
+
+/** @brief Saves frames as QOI or PNG images, encoding and writing them on a thread pool
+ * Capture only copies the frame, so screenshots can be taken every frame of a run without
+ * holding up the emulation. The pool is only started once the first screenshot is taken.
+ * Screenshots asked for by the user are requested, and captured from the next frame shown,
+ * so they're never of a frame that's half drawn.
+ */
+class Screenshots
+{
+public:
+    Screenshots(ImageFormat format);
+    virtual ~Screenshots(); // Waits for every screenshot to be written
+
+    static const int MaxPending = 64; // Capture waits rather than queue more than this
+
+    /** @brief Copies a frame and queues it to be saved
+     * The format comes from the file extension (.qoi or .png), or the default format if
+     * there isn't one. Without a path the file is named screenshot-N after the next free number.
+     *
+     * @param pixels const uint32_t* ScreenWidth * ScreenHeight ARGB8888
+     * @param path string
+     * @return The path the screenshot will be saved to
+     *
+     */
+    std::string Capture(const uint32_t* pixels, std::string path = "");
+    void Wait(); // Waits for every queued screenshot to be written
+
+    void Request(std::string path = ""); // Saves the next frame passed to CaptureRequested, see Capture for the path
+    bool IsRequested();
+    std::string CaptureRequested(const uint32_t* pixels); // Returns the path, or nothing if no screenshot was requested
+
+    uint32_t GetSaved();
+    uint32_t GetFailed();
+
+private:
+    static const int FramePixels = GPU::ScreenWidth * GPU::ScreenHeight;
+
+    ImageFormat format;
+    ThreadPool* pool; // Created with the first screenshot
+    uint32_t nextNumber;
+    bool requested;
+    std::string requestedPath;
+
+    std::atomic<uint32_t> saved;
+    std::atomic<uint32_t> failed;
+
+    std::string NextPath();
+    void Save(const uint32_t* pixels, ImageFormat format, const std::string& path);
+};
+
+#endif // SCREENSHOTS_H
@@ -0,0 +1,193 @@
+#include "VideoRecorder.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+
+static const size_t FileBufferSize = 4 * 1024 * 1024;
+
+VideoRecorder::VideoRecorder() : queue(QueueFrames)
+{
+    file = NULL;
+    fileBuffer = NULL;
+    y4m = false;
+    dropDuplicates = false;
+    haveLastFrame = false;
+    running = false;
+    framesWritten = 0;
+    framesDropped = 0;
+    stalls = 0;
+}
+
+VideoRecorder::~VideoRecorder()
+{
+    Close();
+}
+
+bool VideoRecorder::Open(const char* path, bool dropDuplicates)
+{
+    file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        cout << "Couldn't create " << path << endl;
+        return false;
+    }
+
+    // Let stdio gather frames up into large writes
+    fileBuffer = new char[FileBufferSize];
+    setvbuf(file, fileBuffer, _IOFBF, FileBufferSize);
+
+    string name = path;
+    y4m = name.size() >= 4 && name.compare(name.size() - 4, 4, ".y4m") == 0;
+    if (y4m)
+    {
+        // The real frame rate is 4194304 / 70224 (~59.73) fps
+        fprintf(file, "YUV4MPEG2 W%d H%d F4194304:70224 Ip A1:1 C444\n", GPU::ScreenWidth, GPU::ScreenHeight);
+    }
+
+    this->dropDuplicates = dropDuplicates;
+    haveLastFrame = false;
+    running = true;
+    writerThread = thread(&VideoRecorder::WriterLoop, this);
+    return true;
+}
+
+void VideoRecorder::Close()
+{
+    if (writerThread.joinable())
+    {
+        running = false;
+        frameSignal.notify_one();
+        writerThread.join();
+    }
+
+    if (file != NULL)
+    {
+        fclose(file);
+        file = NULL;
+    }
+    delete[] fileBuffer;
+    fileBuffer = NULL;
+}
+
+void VideoRecorder::PushFrame(const uint32_t* pixels)
+{
+    Frame* frame = queue.BeginWrite();
+    if (frame == NULL)
+    {
+        // The disk has fallen a long way behind, wait for it rather than lose the frame
+        stalls++;
+        while ((frame = queue.BeginWrite()) == NULL)
+        {
+            frameSignal.notify_one();
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+
+    memcpy(frame->pixels, pixels, sizeof(frame->pixels));
+    queue.EndWrite();
+    frameSignal.notify_one();
+}
+
+uint32_t VideoRecorder::GetFramesWritten()
+{
+    return framesWritten;
+}
+
+uint32_t VideoRecorder::GetFramesDropped()
+{
+    return framesDropped;
+}
+
+uint32_t VideoRecorder::GetStalls()
+{
+    return stalls;
+}
+
+/** @brief Writer thread, writes queued frames until the recorder is closed and the queue is empty
+ *
+ * @return void
+ *
+ */
+void VideoRecorder::WriterLoop()
+{
+    while (true)
+    {
+        // Checked before the queue, so every frame pushed before Close is seen before stopping
+        bool stopping = !running;
+
+        const Frame* frame = queue.BeginRead();
+        if (frame != NULL)
+        {
+            if (dropDuplicates && haveLastFrame && memcmp(frame->pixels, lastFrame.pixels, sizeof(lastFrame.pixels)) == 0)
+            {
+                framesDropped++;
+            }
+            else
+            {
+                WriteFrame(*frame);
+                if (dropDuplicates)
+                {
+                    lastFrame = *frame;
+                    haveLastFrame = true;
+                }
+                framesWritten++;
+            }
+            queue.EndRead();
+            continue;
+        }
+
+        if (stopping)
+        {
+            break;
+        }
+
+        // PushFrame doesn't take the lock, so a missed notify is covered by the timeout
+        unique_lock<mutex> lock(signalMutex);
+        frameSignal.wait_for(lock, chrono::milliseconds(10));
+    }
+
+    fflush(file);
+}
+
+/** @brief Converts a frame to the file's format and writes it
+ * Y4M frames are planar YCbCr (BT.601, studio range), raw frames are packed RGB.
+ *
+ * @return void
+ *
+ */
+void VideoRecorder::WriteFrame(const Frame& frame)
+{
+    if (!y4m)
+    {
+        for (int i = 0; i < FramePixels; i++)
+        {
+            uint32_t p = frame.pixels[i];
+            outBuffer[i * 3] = p >> 16 & 0xFF;
+            outBuffer[i * 3 + 1] = p >> 8 & 0xFF;
+            outBuffer[i * 3 + 2] = p & 0xFF;
+        }
+        fwrite(outBuffer, 1, sizeof(outBuffer), file);
+        return;
+    }
+
+    uint8_t* yPlane = outBuffer;
+    uint8_t* cbPlane = outBuffer + FramePixels;
+    uint8_t* crPlane = outBuffer + FramePixels * 2;
+
+    for (int i = 0; i < FramePixels; i++)
+    {
+        int r = frame.pixels[i] >> 16 & 0xFF;
+        int g = frame.pixels[i] >> 8 & 0xFF;
+        int b = frame.pixels[i] & 0xFF;
+
+        yPlane[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        cbPlane[i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+        crPlane[i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+    }
+
+    fputs("FRAME\n", file);
+    fwrite(outBuffer, 1, sizeof(outBuffer), file);
+}
@@ -0,0 +1,76 @@
+#ifndef VIDEORECORDER_H
+#define VIDEORECORDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "GPU/GPU.h"
+#include "Util/RingBuffer.h"
+
+/** @brief Records frames to a Y4M (4:4:4) or raw RGB24 file on a writer thread
+ * Frames are copied into a queue and the writer thread converts and writes them, so all the
+ * emulation thread pays for is the copy. The queue holds several seconds of frames to ride
+ * out slow writes. If it does fill up, PushFrame waits rather than losing frames.
+ */
+class VideoRecorder
+{
+public:
+    VideoRecorder();
+    virtual ~VideoRecorder();
+
+    static const int QueueFrames = 256; // ~4 seconds, 23MB
+
+    /** @brief Creates the file and starts the writer thread
+     * Files ending in .y4m get a YUV4MPEG2 header and are converted to YCbCr, anything else
+     * is written as raw 8 bit RGB.
+     *
+     * @param path const char*
+     * @param dropDuplicates bool Don't write frames identical to the one before
+     * @return false if the file couldn't be created
+     *
+     */
+    bool Open(const char* path, bool dropDuplicates);
+    void Close(); // Writes out every queued frame
+
+    void PushFrame(const uint32_t* pixels); // ScreenWidth * ScreenHeight ARGB8888
+
+    uint32_t GetFramesWritten();
+    uint32_t GetFramesDropped(); // Duplicates that weren't written
+    uint32_t GetStalls(); // Times PushFrame had to wait for the writer
+
+private:
+    static const int FramePixels = GPU::ScreenWidth * GPU::ScreenHeight;
+
+    struct Frame
+    {
+        uint32_t pixels[FramePixels];
+    };
+
+    FILE* file;
+    char* fileBuffer;
+    bool y4m;
+    bool dropDuplicates;
+
+    RingBuffer<Frame> queue;
+    Frame lastFrame; // Only used by the writer
+    bool haveLastFrame;
+    uint8_t outBuffer[FramePixels * 3];
+
+    std::thread writerThread;
+    std::atomic<bool> running;
+    std::mutex signalMutex;
+    std::condition_variable frameSignal;
+
+    std::atomic<uint32_t> framesWritten;
+    std::atomic<uint32_t> framesDropped;
+    uint32_t stalls;
+
+    void WriterLoop();
+    void WriteFrame(const Frame& frame);
+};
+
+#endif // VIDEORECORDER_H
@@ -1,5 +1,6 @@
 #include "GDDB.h"
 
+#include <chrono>
 #include <iostream>
 
 
@@ -51,6 +52,16 @@ void GDDB::PrintRegisters()
     printf("PC: 0x%X\n", r->pc);
 }
 
+void GDDB::SetScreenshots(Screenshots* screenshots)
+{
+    this->screenshots = screenshots;
+}
+
+void GDDB::SetStatePath(string path)
+{
+    statePath = path;
+}
+
 void GDDB::PrintNextInstr()
 {
     uint8_t opcode = z80->GetMMU()->ReadByte(z80->GetRegisters()->pc);
@@ -136,6 +147,18 @@ void GDDB::CommandPrompt()
         {
             ResetCommand();
         }
+        else if (commandArray[0] == "screenshot")
+        {
+            ScreenshotCommand(commandArray[1]);
+        }
+        else if (commandArray[0] == "savestate")
+        {
+            SaveStateCommand(commandArray[1]);
+        }
+        else if (commandArray[0] == "loadstate")
+        {
+            LoadStateCommand(commandArray[1]);
+        }
         // Step to next command or breakpoint, nothing entered
         else if (commandArray[0] == "")
         {
@@ -155,6 +178,9 @@ void GDDB::HelpCommand()
     cout << "Commands" << endl;
     cout << "--------" << endl;
     cout << "debug\tEnables/Disables GDDB" << endl;
+    cout << "screenshot [path]\tSaves the last frame as .qoi or .png" << endl;
+    cout << "savestate [path]\tSaves the machine's state" << endl;
+    cout << "loadstate [path]\tLoads a state saved with savestate or F5" << endl;
 }
 
 /** @brief Sets the breakpoint
@@ -191,3 +217,75 @@ void GDDB::ResetCommand()
     cout << "Resetting WolfGB" << endl;
     z80->Reset();
 }
+
+/** @brief Saves the next frame shown, once it's complete
+ *
+ * @param path string Empty for the next screenshot-N name
+ * @return void
+ *
+ */
+void GDDB::ScreenshotCommand(string path)
+{
+    if (screenshots == NULL)
+    {
+        cout << "Screenshots aren't available" << endl;
+        return;
+    }
+
+    screenshots->Request(path);
+    cout << "The screenshot will be taken when the next frame is shown" << endl;
+}
+
+/** @brief Saves the machine's state to a file
+ *
+ * @param path string Empty for the ROM's state file
+ * @return void
+ *
+ */
+void GDDB::SaveStateCommand(string path)
+{
+    if (path.empty())
+    {
+        path = statePath;
+    }
+
+    auto start = chrono::steady_clock::now();
+    state.Save(z80, true);
+    double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    if (state.WriteFile(path))
+    {
+        printf("Saved %s (%.1fus)\n", path.c_str(), micros);
+    }
+    else
+    {
+        printf("Couldn't save %s: %s\n", path.c_str(), state.GetError());
+    }
+}
+
+void GDDB::LoadStateCommand(string path)
+{
+    if (path.empty())
+    {
+        path = statePath;
+    }
+
+    if (!state.MapFile(path))
+    {
+        printf("Couldn't load %s: %s\n", path.c_str(), state.GetError());
+        return;
+    }
+
+    auto start = chrono::steady_clock::now();
+    bool loaded = state.Load(z80);
+    double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    if (loaded)
+    {
+        printf("Loaded %s (%.1fus)\n", path.c_str(), micros);
+    }
+    else
+    {
+        printf("Couldn't load %s: %s\n", path.c_str(), state.GetError());
+    }
+}
@@ -2,6 +2,8 @@
 #define GDDB_H
 
 #include "Z80/Z80.h"
+#include "Capture/Screenshots.h"
+#include "State/SaveState.h"
 #include <string>
 
 using namespace std;
@@ -16,6 +18,8 @@ class GDDB
 
         void Step();
         void PrintRegisters();
+        void SetScreenshots(Screenshots* screenshots);
+        void SetStatePath(string path); // Where savestate and loadstate go without a path
 
     protected:
     private:
@@ -27,8 +31,14 @@ class GDDB
         void DebugCommand();
         void ResetCommand();
         void TileMapCommand();
+        void ScreenshotCommand(string path);
+        void SaveStateCommand(string path);
+        void LoadStateCommand(string path);
 
         Z80* z80;
+        Screenshots* screenshots = NULL;
+        SaveState state;
+        string statePath;
 
         uint16_t BreakPoint = 0;
 };
@@ -0,0 +1,217 @@
+#include "Display.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+
+Display::Display() : frames(GPU::ScreenWidth * GPU::ScreenHeight)
+{
+    window = NULL;
+    renderer = NULL;
+    texture = NULL;
+    threaded = false;
+    scaled = NULL;
+}
+
+Display::~Display()
+{
+    Close();
+    delete[] scaled;
+}
+
+/** @brief Sets how much frames are scaled up, and the filter used to do it
+ *
+ * @param scale int Integer scale, a multiple of the filter's factor
+ * @param filter ScaleFilter
+ * @return false if the scale and filter can't be used together
+ *
+ */
+bool Display::SetScale(int scale, ScaleFilter filter)
+{
+    if (!scaler.Configure(scale, filter))
+    {
+        return false;
+    }
+
+    delete[] scaled;
+    scaled = NULL;
+    if (scale > 1)
+    {
+        scaled = new uint32_t[scaler.GetWidth() * scaler.GetHeight()];
+    }
+    return true;
+}
+
+/** @brief Creates the window and renderer on the calling thread
+ *
+ * @param title const char* Window title
+ * @param threaded bool Frames will be pushed from another thread while this one calls Run
+ * @return false if the window couldn't be created
+ *
+ */
+bool Display::Open(const char* title, bool threaded)
+{
+    window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, scaler.GetWidth(), scaler.GetHeight(), SDL_WINDOW_SHOWN);
+    if (window == NULL)
+    {
+        cout << "Window could not be created! SDL_Error: " << SDL_GetError() << endl;
+        return false;
+    }
+    if (!CreateRenderer())
+    {
+        return false;
+    }
+
+    this->threaded = threaded;
+    return true;
+}
+
+void Display::Close()
+{
+    DestroyRenderer();
+
+    if (window != NULL)
+    {
+        SDL_DestroyWindow(window);
+        window = NULL;
+    }
+}
+
+bool Display::IsThreaded()
+{
+    return threaded;
+}
+
+void Display::Run(const atomic<bool>& running)
+{
+    while (running)
+    {
+        SDL_Event event;
+        while (SDL_PollEvent(&event) != 0)
+        {
+            lock_guard<mutex> lock(eventMutex);
+            events.push_back(event);
+        }
+
+        {
+            lock_guard<mutex> lock(eventMutex);
+            if (!title.empty())
+            {
+                SDL_SetWindowTitle(window, title.c_str());
+                title.clear();
+            }
+        }
+
+        if (frames.Acquire())
+        {
+            Present(frames.GetReadBuffer());
+            continue;
+        }
+
+        // PushFrame doesn't take the lock, so a missed notify is covered by the timeout, which
+        // also keeps events coming while no frames are
+        unique_lock<mutex> lock(signalMutex);
+        frameSignal.wait_for(lock, chrono::milliseconds(4));
+    }
+}
+
+void Display::PushFrame(const uint32_t* pixels)
+{
+    if (!threaded)
+    {
+        Present(pixels);
+        return;
+    }
+
+    memcpy(frames.GetWriteBuffer(), pixels, GPU::ScreenWidth * GPU::ScreenHeight * sizeof(uint32_t));
+    frames.Publish();
+    frameSignal.notify_one();
+}
+
+bool Display::PollEvent(SDL_Event& event)
+{
+    if (!threaded)
+    {
+        return SDL_PollEvent(&event) != 0;
+    }
+
+    lock_guard<mutex> lock(eventMutex);
+    if (events.empty())
+    {
+        return false;
+    }
+    event = events.front();
+    events.pop_front();
+    return true;
+}
+
+void Display::SetTitle(const char* title)
+{
+    if (!threaded)
+    {
+        SDL_SetWindowTitle(window, title);
+        return;
+    }
+
+    lock_guard<mutex> lock(eventMutex);
+    this->title = title;
+}
+
+/** @brief Creates the renderer, without vsync so presenting never holds up emulation
+ * Frames are paced by the caller.
+ *
+ * @return false if the renderer couldn't be created
+ *
+ */
+bool Display::CreateRenderer()
+{
+    renderer = SDL_CreateRenderer(window, -1, 0);
+    if (renderer == NULL)
+    {
+        cout << "Renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
+        return false;
+    }
+
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, scaler.GetWidth(), scaler.GetHeight());
+
+    // Clear screen
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderPresent(renderer);
+    return true;
+}
+
+void Display::DestroyRenderer()
+{
+    if (texture != NULL)
+    {
+        SDL_DestroyTexture(texture);
+        texture = NULL;
+    }
+    if (renderer != NULL)
+    {
+        SDL_DestroyRenderer(renderer);
+        renderer = NULL;
+    }
+}
+
+void Display::Present(const uint32_t* pixels)
+{
+    if (renderer == NULL)
+    {
+        return;
+    }
+
+    if (scaled != NULL)
+    {
+        scaler.Scale(pixels, scaled);
+        pixels = scaled;
+    }
+
+    SDL_UpdateTexture(texture, NULL, pixels, scaler.GetWidth() * sizeof(uint32_t));
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+}
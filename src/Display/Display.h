@@ -0,0 +1,70 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <SDL.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include "GPU/GPU.h"
+#include "Scaler.h"
+#include "TripleBuffer.h"
+
+/** @brief Shows frames from the GPU in a window
+ * SDL only supports the window, renderer and events on the thread that created the window,
+ * so in threaded mode that thread calls Run to present frames while emulation runs on another.
+ * Frames are handed over through a triple buffer, so neither thread ever waits for the other,
+ * and events are queued up for the emulation thread to take with PollEvent.
+ * In single threaded mode frames are scaled and presented as they are pushed, and events are
+ * taken straight from SDL.
+ */
+class Display
+{
+public:
+    Display();
+    virtual ~Display();
+
+    bool SetScale(int scale, ScaleFilter filter); // Must be called before Open
+    bool Open(const char* title, bool threaded);
+    void Close();
+    bool IsThreaded();
+
+    /** @brief Presents frames and gathers events until running is cleared
+     * Threaded mode only, called on the thread that opened the display.
+     *
+     * @param running const std::atomic<bool>& Cleared by the emulation thread when it stops
+     * @return void
+     *
+     */
+    void Run(const std::atomic<bool>& running);
+
+    // Called from the emulation thread
+    void PushFrame(const uint32_t* pixels); // Copies a ScreenWidth * ScreenHeight ARGB8888 frame
+    bool PollEvent(SDL_Event& event); // Like SDL_PollEvent
+    void SetTitle(const char* title);
+
+private:
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    bool threaded;
+
+    Scaler scaler;
+    uint32_t* scaled; // Frame after scaling, NULL when it's shown at its original size
+
+    TripleBuffer frames; // Pushed, waiting to be presented
+    std::mutex signalMutex;
+    std::condition_variable frameSignal;
+
+    std::mutex eventMutex; // Guards events and title
+    std::deque<SDL_Event> events;
+    std::string title; // Set for Run to pass on to the window, empty once it has
+
+    bool CreateRenderer();
+    void DestroyRenderer();
+    void Present(const uint32_t* pixels); // Scales the frame if needed
+};
+
+#endif // DISPLAY_H
@@ -0,0 +1,147 @@
+#include "FramePacer.h"
+
+#include <thread>
+
+using namespace std;
+
+constexpr double FramePacer::FramesPerSecond;
+const int FramePacer::MaxLagFrames;
+
+FramePacer::FramePacer()
+{
+    realFrameTime = chrono::duration_cast<Clock::duration>(chrono::duration<double>(1.0 / FramesPerSecond));
+    frameTime = realFrameTime;
+    speed = 1.0;
+    waiting = true;
+    lag = Clock::duration::zero();
+    started = false;
+    skipMode = FrameSkip::Off;
+    skipFrames = 0;
+    skipped = 0;
+    measuredFrames = 0;
+    achievedSpeed = 0.0;
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+void FramePacer::SetFrameSkip(FrameSkip mode, int frames)
+{
+    skipMode = mode;
+    skipFrames = frames;
+    skipped = 0;
+}
+
+void FramePacer::SetSpeed(double speed)
+{
+    this->speed = speed;
+    if (speed > 0.0)
+    {
+        frameTime = chrono::duration_cast<Clock::duration>(realFrameTime / speed);
+    }
+
+    // Start from a fresh deadline so the change doesn't show up as lag
+    started = false;
+}
+
+void FramePacer::SetWaiting(bool waiting)
+{
+    if (waiting != this->waiting)
+    {
+        this->waiting = waiting;
+        started = false;
+    }
+}
+
+double FramePacer::GetSpeed()
+{
+    return achievedSpeed;
+}
+
+/** @brief Called when a frame has completed, sleeps until the next one is due
+ *
+ * @return true if the next frame should be drawn
+ *
+ */
+bool FramePacer::EndFrame()
+{
+    Clock::time_point now = Clock::now();
+    if (!started)
+    {
+        deadline = now;
+        measureStart = now;
+        measuredFrames = 0;
+        started = true;
+    }
+
+    deadline += frameTime;
+    if (speed <= 0.0)
+    {
+        lag = Clock::duration::zero();
+    }
+    else if (now < deadline)
+    {
+        if (waiting)
+        {
+            this_thread::sleep_until(deadline);
+            now = deadline;
+        }
+        else
+        {
+            // Running early is up to whatever is pacing, it isn't saved up to skip frames later
+            deadline = now;
+        }
+        lag = Clock::duration::zero();
+    }
+    else
+    {
+        lag = now - deadline;
+
+        // Too far behind (a breakpoint, the window being dragged) to catch up, start again from now
+        if (lag > frameTime * MaxLagFrames)
+        {
+            deadline = now;
+        }
+    }
+
+    measuredFrames++;
+    if (now - measureStart >= chrono::seconds(1))
+    {
+        achievedSpeed = measuredFrames / chrono::duration<double>(now - measureStart).count() / FramesPerSecond;
+        measureStart = now;
+        measuredFrames = 0;
+    }
+
+    bool draw = true;
+    switch (skipMode)
+    {
+    case FrameSkip::Off:
+        break;
+    case FrameSkip::Fixed:
+        draw = skipped >= skipFrames;
+        break;
+    case FrameSkip::Auto:
+        // More than a whole frame behind, drop the next one to make the time up
+        draw = lag < frameTime || skipped >= skipFrames;
+        break;
+    }
+
+    // Faster than real time, frames the screen doesn't have time to show aren't drawn
+    if (draw && (speed <= 0.0 || speed > 1.0) && now - lastDrawn < realFrameTime * 9 / 10)
+    {
+        draw = false;
+    }
+
+    if (draw)
+    {
+        lastDrawn = now;
+    }
+    skipped = draw ? 0 : skipped + 1;
+    return draw;
+}
+
+double FramePacer::GetLag()
+{
+    return chrono::duration<double, milli>(lag).count();
+}
@@ -0,0 +1,68 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <chrono>
+
+enum class FrameSkip
+{
+    Off,
+    Fixed, // Always skip the same number of frames between drawn frames
+    Auto, // Skip frames only while emulation is running behind
+};
+
+/** @brief Keeps emulation running at the Game Boy's frame rate and decides which frames are drawn
+ * Frames are timed against a deadline rather than sleeping a fixed time after each one, so
+ * time spent emulating and presenting doesn't add up into drift. How far behind the deadline
+ * emulation is (the lag) drives automatic frame skipping.
+ * Running faster than real time, frames are only drawn as often as a screen could show them.
+ * When something else keeps time (audio sync waiting on the sound card), the pacer stops
+ * waiting and only measures the lag and decides which frames to skip.
+ */
+class FramePacer
+{
+public:
+    FramePacer();
+    virtual ~FramePacer();
+
+    static constexpr double FramesPerSecond = 4194304.0 / 70224.0; // ~59.73
+
+    /** @brief Sets how frames are skipped
+     *
+     * @param mode FrameSkip
+     * @param frames int Frames skipped between drawn frames (Fixed), or the most skipped in a row (Auto)
+     * @return void
+     *
+     */
+    void SetFrameSkip(FrameSkip mode, int frames);
+    void SetSpeed(double speed); // Multiple of the real frame rate, 0 = uncapped
+    void SetWaiting(bool waiting); // False when something else paces emulation, true by default
+
+    double GetSpeed(); // Speed actually achieved, measured over about a second
+
+    bool EndFrame(); // Waits until the next frame is due, returns whether it should be drawn
+    double GetLag(); // Milliseconds behind the deadline at the end of the last frame
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static const int MaxLagFrames = 8; // Further behind than this, give up catching up
+
+    Clock::duration realFrameTime;
+    Clock::duration frameTime; // realFrameTime divided by the speed
+    double speed;
+    bool waiting;
+    Clock::time_point deadline;
+    Clock::duration lag;
+    bool started;
+
+    FrameSkip skipMode;
+    int skipFrames;
+    int skipped; // Frames skipped since the last drawn frame
+    Clock::time_point lastDrawn;
+
+    Clock::time_point measureStart;
+    int measuredFrames;
+    double achievedSpeed;
+};
+
+#endif // FRAMEPACER_H
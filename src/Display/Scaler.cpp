@@ -0,0 +1,409 @@
+#include "Scaler.h"
+
+#include <string.h>
+#include "GPU/GPU.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define SCALER_X86
+#include <immintrin.h>
+#endif
+
+Scaler::NearestFunc Scaler::nearestRow = NULL;
+Scaler::Scale2xFunc Scaler::scale2xRow = NULL;
+Scaler::Scale3xFunc Scaler::scale3xRow = NULL;
+const char* Scaler::kernelName = "";
+
+static void NearestRowScalar(const uint32_t* in, uint32_t* out, int width, int factor)
+{
+    for (int x = 0; x < width; x++)
+    {
+        for (int i = 0; i < factor; i++)
+        {
+            *out++ = in[x];
+        }
+    }
+}
+
+/*
+ * Scale2x/Scale3x look at the 3x3 block around each pixel E:
+ *   A B C
+ *   D E F
+ *   G H I
+ * An edge runs through a corner of E when the two neighbours either side of that corner are the
+ * same colour and the other two aren't, and the corner then takes their colour.
+ */
+static void Scale2xRowScalar(const uint32_t* above, const uint32_t* row, const uint32_t* below, uint32_t* out0, uint32_t* out1, int width)
+{
+    for (int x = 0; x < width; x++)
+    {
+        uint32_t B = above[x], D = row[x - 1], E = row[x], F = row[x + 1], H = below[x];
+
+        if (B != H && D != F)
+        {
+            out0[x * 2] = D == B ? D : E;
+            out0[x * 2 + 1] = B == F ? F : E;
+            out1[x * 2] = D == H ? D : E;
+            out1[x * 2 + 1] = H == F ? F : E;
+        }
+        else
+        {
+            out0[x * 2] = out0[x * 2 + 1] = out1[x * 2] = out1[x * 2 + 1] = E;
+        }
+    }
+}
+
+static void Scale3xRowScalar(const uint32_t* above, const uint32_t* row, const uint32_t* below, uint32_t* out0, uint32_t* out1, uint32_t* out2, int width)
+{
+    for (int x = 0; x < width; x++)
+    {
+        uint32_t A = above[x - 1], B = above[x], C = above[x + 1];
+        uint32_t D = row[x - 1], E = row[x], F = row[x + 1];
+        uint32_t G = below[x - 1], H = below[x], I = below[x + 1];
+        uint32_t* o0 = out0 + x * 3;
+        uint32_t* o1 = out1 + x * 3;
+        uint32_t* o2 = out2 + x * 3;
+
+        if (B != H && D != F)
+        {
+            bool db = D == B, bf = B == F, dh = D == H, hf = H == F;
+            o0[0] = db ? D : E;
+            o0[1] = (db && E != C) || (bf && E != A) ? B : E;
+            o0[2] = bf ? F : E;
+            o1[0] = (db && E != G) || (dh && E != A) ? D : E;
+            o1[1] = E;
+            o1[2] = (bf && E != I) || (hf && E != C) ? F : E;
+            o2[0] = dh ? D : E;
+            o2[1] = (dh && E != I) || (hf && E != G) ? H : E;
+            o2[2] = hf ? F : E;
+        }
+        else
+        {
+            o0[0] = o0[1] = o0[2] = E;
+            o1[0] = o1[1] = o1[2] = E;
+            o2[0] = o2[1] = o2[2] = E;
+        }
+    }
+}
+
+#ifdef SCALER_X86
+__attribute__((target("sse2")))
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Interleaves 3 vectors of 4 pixels into 12 pixels: a0 b0 c0 a1 b1 c1 ...
+__attribute__((target("sse2")))
+static inline void Store3(uint32_t* out, __m128i a, __m128i b, __m128i c)
+{
+    __m128 ab = _mm_castsi128_ps(_mm_unpacklo_epi32(a, b)); // a0 b0 a1 b1
+    __m128 abHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(a, b)); // a2 b2 a3 b3
+    __m128 bc = _mm_castsi128_ps(_mm_unpacklo_epi32(b, c)); // b0 c0 b1 c1
+    __m128 bcHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(b, c)); // b2 c2 b3 c3
+    __m128 ca = _mm_castsi128_ps(_mm_unpacklo_epi32(c, a)); // c0 a0 c1 a1
+    __m128 caHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(c, a)); // c2 a2 c3 a3
+
+    _mm_storeu_ps((float*)out, _mm_shuffle_ps(ab, ca, _MM_SHUFFLE(3, 0, 1, 0)));
+    _mm_storeu_ps((float*)out + 4, _mm_shuffle_ps(bc, abHigh, _MM_SHUFFLE(1, 0, 3, 2)));
+    _mm_storeu_ps((float*)out + 8, _mm_shuffle_ps(caHigh, bcHigh, _MM_SHUFFLE(3, 2, 3, 0)));
+}
+
+__attribute__((target("sse2")))
+static void NearestRowSSE2(const uint32_t* in, uint32_t* out, int width, int factor)
+{
+    if (factor < 2 || factor > 4)
+    {
+        NearestRowScalar(in, out, width, factor);
+        return;
+    }
+
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + x));
+        __m128i* o = (__m128i*)(out + x * factor);
+
+        if (factor == 2)
+        {
+            _mm_storeu_si128(o, _mm_unpacklo_epi32(v, v));
+            _mm_storeu_si128(o + 1, _mm_unpackhi_epi32(v, v));
+        }
+        else if (factor == 3)
+        {
+            Store3((uint32_t*)o, v, v, v);
+        }
+        else
+        {
+            _mm_storeu_si128(o, _mm_shuffle_epi32(v, 0x00));
+            _mm_storeu_si128(o + 1, _mm_shuffle_epi32(v, 0x55));
+            _mm_storeu_si128(o + 2, _mm_shuffle_epi32(v, 0xAA));
+            _mm_storeu_si128(o + 3, _mm_shuffle_epi32(v, 0xFF));
+        }
+    }
+
+    NearestRowScalar(in + x, out + x * factor, width - x, factor);
+}
+
+__attribute__((target("sse2")))
+static void Scale2xRowSSE2(const uint32_t* above, const uint32_t* row, const uint32_t* below, uint32_t* out0, uint32_t* out1, int width)
+{
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i B = _mm_loadu_si128((const __m128i*)(above + x));
+        __m128i D = _mm_loadu_si128((const __m128i*)(row + x - 1));
+        __m128i E = _mm_loadu_si128((const __m128i*)(row + x));
+        __m128i F = _mm_loadu_si128((const __m128i*)(row + x + 1));
+        __m128i H = _mm_loadu_si128((const __m128i*)(below + x));
+
+        // Only pixels with B != H and D != F change, which is the same as the 4 rules' other tests
+        __m128i flat = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+        __m128i db = _mm_andnot_si128(flat, _mm_cmpeq_epi32(D, B));
+        __m128i bf = _mm_andnot_si128(flat, _mm_cmpeq_epi32(B, F));
+        __m128i dh = _mm_andnot_si128(flat, _mm_cmpeq_epi32(D, H));
+        __m128i hf = _mm_andnot_si128(flat, _mm_cmpeq_epi32(H, F));
+
+        __m128i e0 = Select(db, D, E);
+        __m128i e1 = Select(bf, F, E);
+        __m128i e2 = Select(dh, D, E);
+        __m128i e3 = Select(hf, F, E);
+
+        _mm_storeu_si128((__m128i*)(out0 + x * 2), _mm_unpacklo_epi32(e0, e1));
+        _mm_storeu_si128((__m128i*)(out0 + x * 2 + 4), _mm_unpackhi_epi32(e0, e1));
+        _mm_storeu_si128((__m128i*)(out1 + x * 2), _mm_unpacklo_epi32(e2, e3));
+        _mm_storeu_si128((__m128i*)(out1 + x * 2 + 4), _mm_unpackhi_epi32(e2, e3));
+    }
+
+    Scale2xRowScalar(above + x, row + x, below + x, out0 + x * 2, out1 + x * 2, width - x);
+}
+
+__attribute__((target("sse2")))
+static void Scale3xRowSSE2(const uint32_t* above, const uint32_t* row, const uint32_t* below, uint32_t* out0, uint32_t* out1, uint32_t* out2, int width)
+{
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i A = _mm_loadu_si128((const __m128i*)(above + x - 1));
+        __m128i B = _mm_loadu_si128((const __m128i*)(above + x));
+        __m128i C = _mm_loadu_si128((const __m128i*)(above + x + 1));
+        __m128i D = _mm_loadu_si128((const __m128i*)(row + x - 1));
+        __m128i E = _mm_loadu_si128((const __m128i*)(row + x));
+        __m128i F = _mm_loadu_si128((const __m128i*)(row + x + 1));
+        __m128i G = _mm_loadu_si128((const __m128i*)(below + x - 1));
+        __m128i H = _mm_loadu_si128((const __m128i*)(below + x));
+        __m128i I = _mm_loadu_si128((const __m128i*)(below + x + 1));
+
+        __m128i flat = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+        __m128i db = _mm_andnot_si128(flat, _mm_cmpeq_epi32(D, B));
+        __m128i bf = _mm_andnot_si128(flat, _mm_cmpeq_epi32(B, F));
+        __m128i dh = _mm_andnot_si128(flat, _mm_cmpeq_epi32(D, H));
+        __m128i hf = _mm_andnot_si128(flat, _mm_cmpeq_epi32(H, F));
+
+        // andnot(E == X, rule) is rule && E != X
+        __m128i ea = _mm_cmpeq_epi32(E, A);
+        __m128i ec = _mm_cmpeq_epi32(E, C);
+        __m128i eg = _mm_cmpeq_epi32(E, G);
+        __m128i ei = _mm_cmpeq_epi32(E, I);
+
+        __m128i e1 = _mm_or_si128(_mm_andnot_si128(ec, db), _mm_andnot_si128(ea, bf));
+        __m128i e3 = _mm_or_si128(_mm_andnot_si128(eg, db), _mm_andnot_si128(ea, dh));
+        __m128i e5 = _mm_or_si128(_mm_andnot_si128(ei, bf), _mm_andnot_si128(ec, hf));
+        __m128i e7 = _mm_or_si128(_mm_andnot_si128(ei, dh), _mm_andnot_si128(eg, hf));
+
+        Store3(out0 + x * 3, Select(db, D, E), Select(e1, B, E), Select(bf, F, E));
+        Store3(out1 + x * 3, Select(e3, D, E), E, Select(e5, F, E));
+        Store3(out2 + x * 3, Select(dh, D, E), Select(e7, H, E), Select(hf, F, E));
+    }
+
+    Scale3xRowScalar(above + x, row + x, below + x, out0 + x * 3, out1 + x * 3, out2 + x * 3, width - x);
+}
+#endif
+
+Scaler::Scaler()
+{
+    static bool initialised = (Init(), true);
+    (void)initialised;
+
+    padded = new uint32_t[(GPU::ScreenWidth + 2) * (GPU::ScreenHeight + 2)];
+    filtered = NULL;
+    Configure(1, ScaleFilter::None);
+}
+
+Scaler::~Scaler()
+{
+    delete[] padded;
+    delete[] filtered;
+}
+
+void Scaler::Init()
+{
+    nearestRow = NearestRowScalar;
+    scale2xRow = Scale2xRowScalar;
+    scale3xRow = Scale3xRowScalar;
+    kernelName = "scalar";
+
+#ifdef SCALER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+    {
+        nearestRow = NearestRowSSE2;
+        scale2xRow = Scale2xRowSSE2;
+        scale3xRow = Scale3xRowSSE2;
+        kernelName = "SSE2";
+    }
+#endif
+}
+
+bool Scaler::Configure(int scale, ScaleFilter filter)
+{
+    int factor = filter == ScaleFilter::Scale2x ? 2 : filter == ScaleFilter::Scale3x ? 3 : 1;
+    if (scale < 1 || scale > MaxScale || scale % factor != 0)
+    {
+        return false;
+    }
+
+    this->scale = scale;
+    this->filter = filter;
+    filterFactor = factor;
+
+    delete[] filtered;
+    filtered = NULL;
+    if (factor > 1 && scale != factor)
+    {
+        filtered = new uint32_t[GPU::ScreenWidth * factor * GPU::ScreenHeight * factor];
+    }
+    return true;
+}
+
+int Scaler::GetScale()
+{
+    return scale;
+}
+
+int Scaler::GetWidth()
+{
+    return GPU::ScreenWidth * scale;
+}
+
+int Scaler::GetHeight()
+{
+    return GPU::ScreenHeight * scale;
+}
+
+void Scaler::Scale(const uint32_t* in, uint32_t* out)
+{
+    if (filter == ScaleFilter::None)
+    {
+        ScaleNearest(in, GPU::ScreenWidth, GPU::ScreenHeight, scale, out);
+        return;
+    }
+
+    Pad(in);
+    if (filtered == NULL)
+    {
+        Filter(out);
+        return;
+    }
+
+    Filter(filtered);
+    ScaleNearest(filtered, GPU::ScreenWidth * filterFactor, GPU::ScreenHeight * filterFactor, scale / filterFactor, out);
+}
+
+const char* Scaler::GetName()
+{
+    return kernelName;
+}
+
+/** @brief Switches the row kernels to the named version, so tests can check they all agree.
+ * They're shared by every Scaler.
+ *
+ * @param version const char* "scalar" or "SSE2"
+ * @return false if the CPU can't run it, leaving the version as it was
+ *
+ */
+bool Scaler::UseVersion(const char* version)
+{
+    if (strcmp(version, "scalar") == 0)
+    {
+        nearestRow = NearestRowScalar;
+        scale2xRow = Scale2xRowScalar;
+        scale3xRow = Scale3xRowScalar;
+        kernelName = "scalar";
+        return true;
+    }
+#ifdef SCALER_X86
+    if (strcmp(version, "SSE2") == 0 && __builtin_cpu_supports("sse2"))
+    {
+        nearestRow = NearestRowSSE2;
+        scale2xRow = Scale2xRowSSE2;
+        scale3xRow = Scale3xRowSSE2;
+        kernelName = "SSE2";
+        return true;
+    }
+#endif
+    return false;
+}
+
+/** @brief Copies the frame into the middle of the padded buffer and repeats its edges around it
+ * This lets the filter kernels read the pixels around every pixel without checking bounds.
+ *
+ * @return void
+ *
+ */
+void Scaler::Pad(const uint32_t* in)
+{
+    const int pitch = GPU::ScreenWidth + 2;
+
+    for (int y = 0; y < GPU::ScreenHeight; y++)
+    {
+        uint32_t* row = &padded[(y + 1) * pitch];
+        memcpy(row + 1, &in[y * GPU::ScreenWidth], GPU::ScreenWidth * sizeof(uint32_t));
+        row[0] = row[1];
+        row[pitch - 1] = row[pitch - 2];
+    }
+
+    memcpy(padded, &padded[pitch], pitch * sizeof(uint32_t));
+    memcpy(&padded[(GPU::ScreenHeight + 1) * pitch], &padded[GPU::ScreenHeight * pitch], pitch * sizeof(uint32_t));
+}
+
+void Scaler::Filter(uint32_t* out)
+{
+    const int pitch = GPU::ScreenWidth + 2;
+    const int outWidth = GPU::ScreenWidth * filterFactor;
+
+    for (int y = 0; y < GPU::ScreenHeight; y++)
+    {
+        const uint32_t* row = &padded[(y + 1) * pitch + 1];
+        uint32_t* outRow = &out[y * filterFactor * outWidth];
+
+        if (filter == ScaleFilter::Scale2x)
+        {
+            scale2xRow(row - pitch, row, row + pitch, outRow, outRow + outWidth, GPU::ScreenWidth);
+        }
+        else
+        {
+            scale3xRow(row - pitch, row, row + pitch, outRow, outRow + outWidth, outRow + outWidth * 2, GPU::ScreenWidth);
+        }
+    }
+}
+
+/** @brief Scales by repeating pixels, each row is scaled once and then copied
+ *
+ * @return void
+ *
+ */
+void Scaler::ScaleNearest(const uint32_t* in, int width, int height, int factor, uint32_t* out)
+{
+    const int outWidth = width * factor;
+
+    for (int y = 0; y < height; y++)
+    {
+        uint32_t* outRow = &out[y * factor * outWidth];
+        nearestRow(&in[y * width], outRow, width, factor);
+
+        for (int i = 1; i < factor; i++)
+        {
+            memcpy(outRow + i * outWidth, outRow, outWidth * sizeof(uint32_t));
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef SCALER_H
+#define SCALER_H
+
+#include <stdint.h>
+
+enum class ScaleFilter
+{
+    None, // Integer (nearest neighbour) scaling only
+    Scale2x, // Smooths diagonal edges while doubling, without adding colours
+    Scale3x,
+};
+
+/** @brief Scales frames up on the CPU for the display
+ * The filter is applied first (2x or 3x) and the rest of the scale is made up by repeating
+ * pixels, so the scale has to be a multiple of the filter's factor.
+ * The row kernels have SSE2 versions, picked the first time a Scaler is created when the
+ * CPU supports it.
+ */
+class Scaler
+{
+public:
+    Scaler();
+    virtual ~Scaler();
+
+    static const int MaxScale = 8;
+
+    bool Configure(int scale, ScaleFilter filter); // Returns false if the combination isn't possible
+    int GetScale();
+    int GetWidth(); // Size of the scaled frame
+    int GetHeight();
+
+    /** @brief Scales a frame
+     *
+     * @param in const uint32_t* ScreenWidth * ScreenHeight ARGB8888 pixels
+     * @param out uint32_t* GetWidth() * GetHeight() pixels
+     * @return void
+     *
+     */
+    void Scale(const uint32_t* in, uint32_t* out);
+
+    const char* GetName(); // Name of the kernel version in use
+    bool UseVersion(const char* version); // Switches every Scaler to a version by name for tests, false if the CPU can't run it
+
+private:
+    // Rows passed to the filter kernels have a valid pixel before the first and after the last
+    typedef void (*NearestFunc)(const uint32_t* in, uint32_t* out, int width, int factor);
+    typedef void (*Scale2xFunc)(const uint32_t* above, const uint32_t* row, const uint32_t* below, uint32_t* out0, uint32_t* out1, int width);
+    typedef void (*Scale3xFunc)(const uint32_t* above, const uint32_t* row, const uint32_t* below, uint32_t* out0, uint32_t* out1, uint32_t* out2, int width);
+
+    static NearestFunc nearestRow;
+    static Scale2xFunc scale2xRow;
+    static Scale3xFunc scale3xRow;
+    static const char* kernelName;
+
+    static void Init();
+
+    int scale;
+    ScaleFilter filter;
+    int filterFactor;
+
+    uint32_t* padded; // Source frame with its edge pixels repeated around it
+    uint32_t* filtered; // Output of the filter, when it still needs scaling further
+
+    void Pad(const uint32_t* in);
+    void Filter(uint32_t* out);
+    void ScaleNearest(const uint32_t* in, int width, int height, int factor, uint32_t* out);
+};
+
+#endif // SCALER_H
@@ -0,0 +1,43 @@
+#include "TripleBuffer.h"
+
+TripleBuffer::TripleBuffer(size_t pixels)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        buffers[i].resize(pixels);
+    }
+    writeIndex = 0;
+    middle = 1;
+    readIndex = 2;
+}
+
+TripleBuffer::~TripleBuffer()
+{
+}
+
+uint32_t* TripleBuffer::GetWriteBuffer()
+{
+    return buffers[writeIndex].data();
+}
+
+void TripleBuffer::Publish()
+{
+    // release: the frame's pixels must be visible before the reader can swap it in
+    writeIndex = middle.exchange(writeIndex | NewFrame, std::memory_order_acq_rel) & ~NewFrame;
+}
+
+bool TripleBuffer::Acquire()
+{
+    if (!(middle.load(std::memory_order_relaxed) & NewFrame))
+    {
+        return false;
+    }
+
+    readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & ~NewFrame;
+    return true;
+}
+
+const uint32_t* TripleBuffer::GetReadBuffer()
+{
+    return buffers[readIndex].data();
+}
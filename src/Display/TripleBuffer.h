@@ -0,0 +1,35 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+/** @brief Lock free triple buffer for handing frames from one thread to another
+ * The writer fills the back buffer and publishes it, swapping it with the middle buffer.
+ * The reader swaps the middle buffer with the front buffer when a new frame has been
+ * published. Neither side ever waits for the other, the reader just sees the newest frame.
+ */
+class TripleBuffer
+{
+public:
+    TripleBuffer(size_t pixels); // Size of each frame
+    virtual ~TripleBuffer();
+
+    uint32_t* GetWriteBuffer();
+    void Publish(); // Makes the write buffer the newest frame
+
+    bool Acquire(); // Returns true if a new frame has been published since the last call
+    const uint32_t* GetReadBuffer();
+
+private:
+    static const int NewFrame = 0x4; // Set in middle when it holds a frame the reader hasn't seen
+
+    std::vector<uint32_t> buffers[3];
+    int writeIndex;
+    int readIndex;
+    std::atomic<int> middle;
+};
+
+#endif // TRIPLEBUFFER_H
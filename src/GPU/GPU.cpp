@@ -1,11 +1,31 @@
 #include "GPU.h"
+#include "Util/Hash.h"
 
 #include "stdio.h"
-#include <unistd.h>
+#include <math.h>
+#include <string.h>
 
-GPU::GPU()
+static const uint32_t SchemeColours[][4] =
 {
-    windowRenderer = NULL;
+    { 0xFFFFFF, 0xAAAAAA, 0x555555, 0x000000 }, // Grayscale
+    { 0x9BBC0F, 0x8BAC0F, 0x306230, 0x0F380F }, // ClassicGreen
+};
+
+GPU::GPU() : vram(MemorySizes.VIDEO_RAM_SIZE)
+{
+    frameCount = 0;
+    drawnFrame = 0;
+    submittedFrame = 0;
+    renderMode = RenderMode::Scanline;
+    drawNextFrame = true;
+    showNextFrame = true;
+    frameShown = false;
+    submittedShown = false;
+    colourScheme = ColourScheme::Grayscale;
+    memcpy(customColours, SchemeColours[0], sizeof(customColours));
+    gamma = 1.0f;
+    BuildColourTable();
+
     Reset();
 }
 
@@ -15,13 +35,10 @@ GPU::~GPU()
 
 void GPU::Reset()
 {
-    if (windowRenderer != NULL)
+    // Clear screen
+    for (int i = 0; i < ScreenWidth * ScreenHeight; i++)
     {
-        // Clear screen
-        SDL_SetRenderDrawColor(windowRenderer, 0, 0, 0, 255);
-        SDL_RenderClear(windowRenderer);
-
-        SDL_RenderPresent(windowRenderer);
+        frameBuffer[i] = 0xFF000000;
     }
     // Clear OAM
     for (int i = 0; i < MemorySizes.OAM_SIZE; i++)
@@ -29,8 +46,19 @@ void GPU::Reset()
         oam[i] = 0;
     }
 
+    // VRAM isn't cleared, so decode every tile again before the next line is drawn
+    MarkAllTilesDirty();
+
+    // Drop a frame still being drawn from before the reset
+    worker.Finish();
+
     lineMode = ModeFlags::OAMRead;
     modeClock = 0;
+    drawFrame = drawNextFrame;
+    showFrame = showNextFrame;
+    frameDrawn = false;
+    memset(lineRegisters, 0, sizeof(lineRegisters));
+    windowLine = 0;
     LCDC = 0;
     STAT = 0;
     ScrollY = 0;
@@ -59,7 +87,7 @@ void GPU::Step(uint8_t clockCycles)
         if (modeClock >= 80)
         {
             // Enter mode 3
-            modeClock = 0;
+            modeClock -= 80; // Keep the cycles the last instruction ran over by, so a frame is exactly 70224 cycles
             lineMode = ModeFlags::OAMWrite;
         }
         break;
@@ -68,10 +96,16 @@ void GPU::Step(uint8_t clockCycles)
         if (modeClock >= 172)
         {
             // Enter HBlank, render scanline to display
-            modeClock = 0;
+            modeClock -= 172;
             lineMode = ModeFlags::HBlank;
 
-            RenderScanLine();
+            // Latched whether or not the frame is drawn, they're part of the state and it
+            // shouldn't depend on which frames were drawn
+            LatchLine();
+            if (drawFrame && renderMode == RenderMode::Scanline)
+            {
+                RenderScanLine(LY);
+            }
         }
         break;
 
@@ -81,15 +115,31 @@ void GPU::Step(uint8_t clockCycles)
         if (modeClock >= 204)
         {
             LY++;
-            modeClock = 0;
+            modeClock -= 204;
 
             // End of hblank for last scanline; render screen
             if (LY == 144)
             {
                 // Enter VBlank
                 lineMode = ModeFlags::VBlank;
-                SDL_RenderPresent(windowRenderer);
-                usleep((1000 / 60) * 1000);
+                frameCount++;
+                if (renderMode == RenderMode::Pipelined)
+                {
+                    SubmitFrame();
+                }
+                else
+                {
+                    if (drawFrame && renderMode == RenderMode::Deferred)
+                    {
+                        RenderFrame();
+                    }
+                    frameDrawn = drawFrame;
+                    if (frameDrawn)
+                    {
+                        drawnFrame = frameCount;
+                        frameShown = showFrame;
+                    }
+                }
             }
             // Go to OAM Read mode for next line
             else
@@ -102,7 +152,7 @@ void GPU::Step(uint8_t clockCycles)
     case ModeFlags::VBlank:
         if (modeClock >= 456)
         {
-            modeClock = 0;
+            modeClock -= 456;
             LY++;
 
             if (LY == 154)
@@ -110,6 +160,8 @@ void GPU::Step(uint8_t clockCycles)
                 // Restart scanning modes
                 lineMode = ModeFlags::OAMRead;
                 LY = 0;
+                drawFrame = drawNextFrame;
+                showFrame = showNextFrame;
             }
         }
 
@@ -118,9 +170,223 @@ void GPU::Step(uint8_t clockCycles)
     }
 }
 
-void GPU::SetRenderer(SDL_Renderer* renderer)
+void GPU::SetRenderMode(RenderMode mode)
+{
+    if (mode == renderMode)
+    {
+        return;
+    }
+
+    // The GPU's renderer and the worker each keep their own decoded tiles, and only one of
+    // them has been kept up to date
+    MarkAllTilesDirty();
+    renderMode = mode;
+}
+
+void GPU::SetDrawNextFrame(bool draw, bool show)
+{
+    drawNextFrame = draw;
+    showNextFrame = draw && show;
+}
+
+bool GPU::IsFrameDrawn()
+{
+    return frameDrawn;
+}
+
+uint32_t GPU::GetDrawnFrame()
+{
+    return drawnFrame;
+}
+
+bool GPU::IsFrameShown()
+{
+    return frameShown;
+}
+
+void GPU::SetColourScheme(ColourScheme scheme)
+{
+    colourScheme = scheme;
+    BuildColourTable();
+}
+
+void GPU::SetCustomColours(const uint32_t* colours)
+{
+    memcpy(customColours, colours, sizeof(customColours));
+    BuildColourTable();
+}
+
+void GPU::SetGamma(float gamma)
+{
+    this->gamma = gamma;
+    BuildColourTable();
+}
+
+const uint32_t* GPU::GetFrameBuffer()
+{
+    return frameBuffer;
+}
+
+uint32_t GPU::GetFrameCount()
+{
+    return frameCount;
+}
+
+/** @brief Hashes the frame buffer
+ * The hash is of the ARGB pixels, so it depends on the colour scheme and gamma as well as
+ * what was drawn. It's only calculated when asked for, so hashing every Nth frame costs
+ * nothing on the others.
+ *
+ * @return uint64_t
+ *
+ */
+uint64_t GPU::GetFrameHash()
+{
+    return Hash::Hash64(frameBuffer, sizeof(frameBuffer));
+}
+
+/** @brief Writes the GPU's section of a save state
+ * The frame buffer is left out, it's output rather than state and is redrawn by the next frame.
+ *
+ * @return void
+ *
+ */
+void GPU::SaveState(StateWriter& state)
+{
+    state.BeginSection(StateTag("GPU "));
+    vram.SaveState(state);
+    state.Write(oam);
+    state.Write(lineRegisters);
+    state.Write(windowLine);
+    state.Write(lineMode);
+    state.Write(modeClock);
+    state.Write(frameCount);
+
+    const uint8_t registers[] = { LCDC, STAT, ScrollY, ScrollX, LY, LYC, DMA, BGPalette, ObjPalette0, ObjPalette1, WinPosY, WinPosX };
+    state.Write(registers);
+    state.Write(dummyVar);
+    state.EndSection();
+}
+
+void GPU::LoadState(StateReader& state)
+{
+    // A frame being drawn on the worker is from before the state
+    worker.Finish();
+
+    state.OpenSection(StateTag("GPU "));
+    vram.LoadState(state);
+    state.Read(oam);
+    state.Read(lineRegisters);
+    state.Read(windowLine);
+    state.Read(lineMode);
+    state.Read(modeClock);
+    state.Read(frameCount);
+
+    uint8_t registers[12];
+    state.Read(registers);
+    uint8_t* targets[] = { &LCDC, &STAT, &ScrollY, &ScrollX, &LY, &LYC, &DMA, &BGPalette, &ObjPalette0, &ObjPalette1, &WinPosY, &WinPosX };
+    for (int i = 0; i < 12; i++)
+    {
+        *targets[i] = registers[i];
+    }
+    state.Read(dummyVar);
+
+    MarkAllTilesDirty();
+    drawFrame = drawNextFrame;
+    showFrame = showNextFrame;
+    frameDrawn = false;
+}
+
+void GPU::CheckState(StateReader& state)
+{
+    state.OpenSection(StateTag("GPU "));
+    vram.CheckState(state);
+    state.Skip(sizeof(oam));
+    state.Skip(sizeof(lineRegisters));
+    state.Skip(sizeof(windowLine));
+    state.Skip(sizeof(lineMode));
+    state.Skip(sizeof(modeClock));
+    state.Skip(sizeof(frameCount));
+    state.Skip(12); // Registers
+    state.Skip(sizeof(dummyVar));
+    state.CloseSection();
+}
+
+/** @brief Makes this GPU carry on from where parent is
+ * Only what LoadState would restore is copied. VRAM is shared, and the tiles are decoded
+ * again from it if the fork draws.
+ *
+ * @return void
+ *
+ */
+void GPU::ForkFrom(GPU& parent)
+{
+    worker.Finish();
+
+    vram.ShareFrom(parent.vram);
+    memcpy(oam, parent.oam, sizeof(oam));
+    memcpy(lineRegisters, parent.lineRegisters, sizeof(lineRegisters));
+    windowLine = parent.windowLine;
+    lineMode = parent.lineMode;
+    modeClock = parent.modeClock;
+    frameCount = parent.frameCount;
+
+    LCDC = parent.LCDC;
+    STAT = parent.STAT;
+    ScrollY = parent.ScrollY;
+    ScrollX = parent.ScrollX;
+    LY = parent.LY;
+    LYC = parent.LYC;
+    DMA = parent.DMA;
+    BGPalette = parent.BGPalette;
+    ObjPalette0 = parent.ObjPalette0;
+    ObjPalette1 = parent.ObjPalette1;
+    WinPosY = parent.WinPosY;
+    WinPosX = parent.WinPosX;
+    dummyVar = parent.dummyVar;
+
+    MarkAllTilesDirty();
+    drawFrame = drawNextFrame;
+    showFrame = showNextFrame;
+    frameDrawn = false;
+}
+
+void GPU::Unshare()
+{
+    vram.Unshare();
+}
+
+size_t GPU::GetPagesCopied()
 {
-    this->windowRenderer = renderer;
+    return vram.GetPagesCopied();
+}
+
+/** @brief Builds the table of ARGB colours for the 4 shades
+ * Gamma correction is applied here so drawing pixels is only a table lookup.
+ * The palettes (BGP, OBP0, OBP1) are applied before this by the pixel pipeline.
+ *
+ * @return void
+ *
+ */
+void GPU::BuildColourTable()
+{
+    const uint32_t* colours = colourScheme == ColourScheme::Custom ? customColours : SchemeColours[(int)colourScheme];
+    for (int i = 0; i < 4; i++)
+    {
+        uint32_t colour = 0xFF000000;
+        for (int shift = 0; shift < 24; shift += 8)
+        {
+            float channel = (colours[i] >> shift & 0xFF) / 255.0f;
+            if (gamma != 1.0f)
+            {
+                channel = powf(channel, 1.0f / gamma);
+            }
+            colour |= (uint32_t)(channel * 255.0f + 0.5f) << shift;
+        }
+        colourTable[i] = colour;
+    }
+
+    renderer.SetColours(colourTable);
 }
 
 uint8_t* GPU::GetMemoryPtr(uint16_t address)
@@ -130,12 +396,17 @@ uint8_t* GPU::GetMemoryPtr(uint16_t address)
     // Video/Graphics RAM
     case 0x8000:
     case 0x9000:
-        return &vram[address & 0x1FFF];
+        return vram.GetPtr(address & 0x1FFF);
 
     case 0xF000:
-        if ((address & 0xFF00) == 0xFE)
+        if ((address & 0xFF00) == 0xFE00)
         {
-            return &oam[address & 0x9F];
+            // 0xFEA0-0xFEFF is unusable
+            if ((address & 0xFF) >= MemorySizes.OAM_SIZE)
+            {
+                return &dummyVar;
+            }
+            return &oam[address & 0xFF];
         }
         else if ((address & 0xFFF0) == 0xFF40)
         {
@@ -172,140 +443,123 @@ uint8_t* GPU::GetMemoryPtr(uint16_t address)
 //        printf("UNSUPPORTED GPU MEMORY LOCATION: 0x%X", address);
 //        return &0;
     }
-}
 
-void GPU::RenderScanLine()
-{
-    RenderBgLine();
-    RenderWindowLine();
+    return &dummyVar;
 }
 
-void GPU::RenderBgLine()
+/** @brief Gets a pointer to write through
+ * Every CPU write to VRAM comes through here, including the read-modify-write instructions,
+ * so a tile written to is decoded again before it's next drawn.
+ *
+ * @param address uint16_t
+ * @return uint8_t*
+ *
+ */
+uint8_t* GPU::GetWritePtr(uint16_t address)
 {
-    uint16_t tileMapAddress = GetBgTileMapAddress();
-    uint16_t tileDataAddress = GetTileDataAddress(tileMapAddress);
-
-    uint8_t tileLow = ReadByte(tileDataAddress);
-    uint8_t tileHigh = ReadByte(tileDataAddress + 1);
-    int tileX = ScrollX >> 3;
-
-    for (int x = 0; x < ScreenWidth; x++)
+    if ((address & 0xE000) != 0x8000)
     {
-        // Draw the current tile
-        uint8_t paletteColour = tileLow >> (7 - tileX) & 0x1;
-        paletteColour |= (tileHigh >> (7 - tileX) & 0x1) << 1;
-        uint8_t colourFromPal = (BGPalette >> paletteColour * 2) & 0x3;
-
-        SetPixel(windowRenderer, x, LY, colourFromPal);
-
-        tileX++;
-        if (tileX == 8)
-        {
-            // Finished with this tile, go to the next one
-            tileX = 0;
-            tileMapAddress++;
-            tileDataAddress = GetTileDataAddress(tileMapAddress);
-            tileLow = ReadByte(tileDataAddress);
-            tileHigh = ReadByte(tileDataAddress + 1);
-        }
+        return GetMemoryPtr(address);
     }
 
+    if (address < 0x9800)
+    {
+        tileDirty[(address & 0x1FFF) >> 4] = true;
+        tilesDirty = true;
+    }
+    return vram.GetWritePtr(address & 0x1FFF);
 }
 
-void GPU::RenderWindowLine()
-{
-
-}
-
-void GPU::SetPixel(SDL_Renderer* renderer, uint8_t x, uint8_t y, uint8_t colour)
-{
-    switch (colour)
-        {
-        case 0:
-            SDL_SetRenderDrawColor(windowRenderer, 255, 255, 255, 255);
-            break;
-        case 1:
-            SDL_SetRenderDrawColor(windowRenderer, 170, 170, 170, 255);
-            break;
-        case 2:
-            SDL_SetRenderDrawColor(windowRenderer, 85, 85, 85, 255);
-            break;
-        case 3:
-            SDL_SetRenderDrawColor(windowRenderer, 0, 0, 0, 255);
-            break;
-        default:
-            printf("GPU: Invalid colour from palette: %i\n", colour);
-        }
-
-        SDL_RenderDrawPoint(windowRenderer, x, y);
-}
-
-bool GPU::LcdEnabled()
+/** @brief Saves the registers that affect drawing the current line
+ * In deferred mode the frame is drawn from these at VBlank, so changes made between lines
+ * (raster effects) still show up on the right lines.
+ *
+ * @return void
+ *
+ */
+void GPU::LatchLine()
 {
-    return LCDC >> 7 & 1;
+    LineRegisters& regs = lineRegisters[LY];
+    regs.LCDC = LCDC;
+    regs.ScrollY = ScrollY;
+    regs.ScrollX = ScrollX;
+    regs.BGPalette = BGPalette;
+    regs.ObjPalette0 = ObjPalette0;
+    regs.ObjPalette1 = ObjPalette1;
+    regs.WinPosY = WinPosY;
+    regs.WinPosX = WinPosX;
+
+    // Only lines the window is drawn on move it down, so it carries on from where it left off
+    // if it's turned off partway down the screen
+    if (LY == 0)
+    {
+        windowLine = 0;
+    }
+    regs.WindowLine = windowLine;
+    if (regs.WindowVisible(LY))
+    {
+        windowLine++;
+    }
 }
 
-uint16_t GPU::GetWindowTileMapAddress()
-{
-    if (LCDC >> 6 & 1) // Shift bit 6 to bit 0 and make sure it's the only value
-        return 0x9C00;
-    else
-        return 0x9800;
-}
 
-bool GPU::WindowEnabled()
+void GPU::RenderFrame()
 {
-    return LCDC >> 5 & 1;
+    UpdateTiles();
+    renderer.RenderFrame(vram.GetPages(), oam, lineRegisters, frameBuffer);
 }
 
-/** @brief Gets the tilemap address
- * Returns the tilemap address of the tile located at the start of the scanline
- * ((SCY + LY) * 32 + SCX)
- *
- * @return uint16_t
- *
- */
-uint16_t GPU::GetBgTileMapAddress()
+void GPU::RenderScanLine(uint8_t line)
 {
-    uint16_t memoryAdd = (LCDC >> 3 & 1) == 0 ? 0x9800 : 0x9C00; // Get base address
-    memoryAdd += ((ScrollY + LY & 0xFF) >> 3) * 32; // point to the correct line
-    memoryAdd += ScrollX >> 3; // point to the start of the scanline
-    return memoryAdd;
+    UpdateTiles();
+    renderer.RenderScanLine(vram.GetPages(), oam, lineRegisters[line], line, frameBuffer);
 }
 
-/** @brief Gets the tile data address
- * Gets the tile data address for the index given at tileMapAddress
+/** @brief Hands the frame that has just finished to the render worker
+ * The frame submitted at the last VBlank has had a whole frame of CPU time to be drawn,
+ * so it's usually done already. That frame is the one that ends up in the frame buffer.
  *
- * @param tileDataAddress uint8_t
- * @return uint16_t
+ * @return void
  *
  */
-uint16_t GPU::GetTileDataAddress(uint16_t tileMapAddress)
+void GPU::SubmitFrame()
 {
-    uint8_t tileNum = ReadByte(tileMapAddress);
-    uint16_t tileDataAddress = (LCDC >> 4 & 1) == 0 ? 0x9000 : 0x8000;
-
-    if (tileDataAddress == 0x9000)
+    frameDrawn = worker.Finish();
+    if (frameDrawn)
     {
-        // Cast to signed integer when we use tilenum
-        tileDataAddress += (int8_t)tileNum * 16;
+        memcpy(frameBuffer, worker.GetFrameBuffer(), sizeof(frameBuffer));
+        drawnFrame = submittedFrame;
+        frameShown = submittedShown;
     }
-    else
+
+    if (drawFrame)
     {
-        tileDataAddress += tileNum * 16;
+        worker.Submit(vram.GetPages(), oam, lineRegisters, tileDirty, colourTable);
+        submittedFrame = frameCount;
+        submittedShown = showFrame;
+        tilesDirty = false;
     }
+}
 
-    // Point to the correct row within the tile
-    tileDataAddress += (ScrollY + LY & 0x7) * 2;
-    return tileDataAddress;
+void GPU::UpdateTiles()
+{
+    if (tilesDirty)
+    {
+        renderer.UpdateTiles(vram.GetPages(), tileDirty);
+        tilesDirty = false;
+    }
 }
 
-bool GPU::ObjectEnabled()
+void GPU::MarkAllTilesDirty()
 {
-    return LCDC >> 1 & 0;
+    for (int i = 0; i < Renderer::TileCount; i++)
+    {
+        tileDirty[i] = true;
+    }
+    tilesDirty = true;
 }
 
-bool GPU::BackgroundEnabled()
+bool GPU::LcdEnabled()
 {
-    return LCDC & 1;
+    return LCDC >> 7 & 1;
 }
@@ -1,10 +1,13 @@
 #ifndef GPU_H
 #define GPU_H
 
-#include <SDL.h>
 #include <stdint.h>
 #include "Z80/Registers.h"
 #include "IMemoryDevice.h"
+#include "Memory/PagedMemory.h"
+#include "Renderer.h"
+#include "RenderWorker.h"
+#include "State/StateStream.h"
 
 enum class ModeFlags
 {
@@ -14,20 +17,56 @@ enum class ModeFlags
     OAMWrite = 3, // Writing OAM data to display driver
 };
 
+enum class RenderMode
+{
+    Scanline, // Each line is drawn as soon as the GPU has finished with it
+    Deferred, // Registers are latched per line and the whole frame is drawn at VBlank
+    Pipelined, // As Deferred, but drawn on a worker thread while the next frame runs. Frames are a frame late.
+};
+
+enum class ColourScheme
+{
+    Grayscale,
+    ClassicGreen, // The green tint of the original DMG screen
+    Custom, // Set with GPU::SetCustomColours
+};
+
 class GPU: public IMemoryDevice
 {
     public:
         GPU();
         virtual ~GPU();
 
-        static const int ScreenWidth = 160;
-        static const int ScreenHeight = 144;
+        static const int ScreenWidth = Renderer::ScreenWidth;
+        static const int ScreenHeight = Renderer::ScreenHeight;
 
         void Reset();
         void Step(uint8_t clockCycles);
-        void SetRenderer(SDL_Renderer* renderer);
+        void SetRenderMode(RenderMode mode);
+
+        // Frames that aren't drawn keep exactly the same timing but do no pixel work at all
+        void SetDrawNextFrame(bool draw, bool show = true); // Takes effect when the next frame starts at line 0
+        bool IsFrameDrawn(); // Whether the frame buffer was updated when the last frame completed
+        uint32_t GetDrawnFrame(); // GetFrameCount of the frame in the frame buffer, one behind when pipelined
+        bool IsFrameShown(); // Whether the frame in the frame buffer is for the screen, or only drawn to be captured
+
+        void SetColourScheme(ColourScheme scheme);
+        void SetCustomColours(const uint32_t* colours); // 4 colours as 0xRRGGBB, lightest first
+        void SetGamma(float gamma); // 1.0 = no correction
+
+        const uint32_t* GetFrameBuffer(); // ARGB8888, ScreenWidth * ScreenHeight
+        uint32_t GetFrameCount(); // Incremented each time a frame has been completed (entering VBlank)
+        uint64_t GetFrameHash(); // Hash of the frame buffer, for comparing frames against known good runs
 
         uint8_t* GetMemoryPtr(uint16_t address);
+        uint8_t* GetWritePtr(uint16_t address); // Marks tiles written to be decoded again
+
+        void SaveState(StateWriter& state);
+        void LoadState(StateReader& state);
+        void CheckState(StateReader& state); // Skips what LoadState reads, see Z80::LoadState
+        void ForkFrom(GPU& parent); // Shares parent's VRAM pages. The frame buffer and drawing settings aren't copied.
+        void Unshare(); // Gives VRAM its own copy of pages shared with forks or a mapped state
+        size_t GetPagesCopied(); // Copies made on write to VRAM
 
     protected:
     private:
@@ -48,31 +87,50 @@ class GPU: public IMemoryDevice
         uint8_t WinPosY; // Window Y position
         uint8_t WinPosX; // Window X position
 
-        uint8_t vram[MemorySizes.VIDEO_RAM_SIZE];
+        RenderMode renderMode;
+        bool drawFrame; // Whether the current frame is being drawn
+        bool drawNextFrame;
+        bool frameDrawn;
+        bool showFrame; // Whether the current frame is for the screen
+        bool showNextFrame;
+        bool frameShown;
+        bool submittedShown;
+        LineRegisters lineRegisters[ScreenHeight];
+        uint8_t windowLine; // Window rows reached so far this frame, counted as lines are latched
+
+        PagedMemory vram; // Shared with forks until written
         uint8_t oam[MemorySizes.OAM_SIZE];
 
-        // Pointer to the screen
-        SDL_Renderer* windowRenderer;
+        // Tiles written since they were last decoded
+        bool tileDirty[Renderer::TileCount];
+        bool tilesDirty; // Set if any tile needs decoding
+
+        Renderer renderer;
+        RenderWorker worker;
+
+        uint32_t frameBuffer[ScreenWidth * ScreenHeight];
+        uint32_t frameCount;
+        uint32_t drawnFrame; // Frame in frameBuffer
+        uint32_t submittedFrame; // Frame being drawn by the worker
+
+        ColourScheme colourScheme;
+        uint32_t customColours[4];
+        float gamma;
+        uint32_t colourTable[4]; // ARGB colours of the 4 shades, with gamma applied
 
         // Renders scanline
-        void RenderScanLine();
-        void RenderBgLine();
-        void RenderWindowLine();
-        void RenderOAMLine();
-
-        void SetPixel(SDL_Renderer* renderer, uint8_t x, uint8_t y, uint8_t colour);
-
-        // Functions to obtain information from LCDC 0xFF40
-        bool LcdEnabled(); // bit 7
-        uint16_t GetWindowTileMapAddress();
-        bool WindowEnabled();
-        uint16_t GetTileDataAddress(uint16_t tileMapAddress);
-        uint16_t GetBgTileMapAddress(); // 9800-9BFF if off, 9C00-9FFF if on
-        bool ObjectSize(); // False = 8x8, True = 8x16
-        bool ObjectEnabled();
-        bool BackgroundEnabled(); // bit 0
-
-        uint16_t dummyVar = 0;
+        void LatchLine();
+        void RenderFrame();
+        void RenderScanLine(uint8_t line);
+        void SubmitFrame();
+        void UpdateTiles();
+        void MarkAllTilesDirty();
+
+        void BuildColourTable();
+
+        bool LcdEnabled(); // LCDC bit 7
+
+        uint8_t dummyVar = 0;
 };
 
 #endif // GPU_H
@@ -0,0 +1,277 @@
+#include "PixelPipeline.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define PIXELPIPELINE_X86
+#include <immintrin.h>
+#endif
+
+PixelPipeline::ComposeFunc PixelPipeline::compose = NULL;
+PixelPipeline::MapFunc PixelPipeline::mapColours = NULL;
+const char* PixelPipeline::composeName = "";
+uint64_t PixelPipeline::spreadTable[256];
+
+static void ComposeScalar(const uint8_t* table, const uint8_t* bg, const uint8_t* obj, const uint8_t* objAttributes, uint8_t* out, int count)
+{
+    for (int x = 0; x < count; x++)
+    {
+        uint8_t colour = bg[x];
+
+        // Sprites with the priority bit set are hidden behind background colours 1-3
+        if (obj[x] != 0 && (!(objAttributes[x] & 0x80) || colour == 0))
+        {
+            colour = obj[x] | ((objAttributes[x] & 0x10) ? 8 : 4);
+        }
+
+        out[x] = table[colour];
+    }
+}
+
+static void MapColoursScalar(const uint32_t* colours, const uint8_t* shades, uint32_t* out, int count)
+{
+    for (int x = 0; x < count; x++)
+    {
+        out[x] = colours[shades[x]];
+    }
+}
+
+#ifdef PIXELPIPELINE_X86
+// Byte n of each pixel comes from byte (shade * 4 + n) of the 16 byte colour table
+__attribute__((target("ssse3")))
+static void MapColoursSSSE3(const uint32_t* colours, const uint8_t* shades, uint32_t* out, int count)
+{
+    const __m128i table = _mm_loadu_si128((const __m128i*)colours);
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+    const __m128i byteIndex = _mm_setr_epi8(0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3);
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        int32_t four;
+        memcpy(&four, shades + x, 4);
+        __m128i index = _mm_shuffle_epi8(_mm_cvtsi32_si128(four), spread);
+        index = _mm_add_epi8(_mm_slli_epi16(index, 2), byteIndex);
+        _mm_storeu_si128((__m128i*)(out + x), _mm_shuffle_epi8(table, index));
+    }
+
+    MapColoursScalar(colours, shades + x, out + x, count - x);
+}
+
+__attribute__((target("avx2")))
+static void MapColoursAVX2(const uint32_t* colours, const uint8_t* shades, uint32_t* out, int count)
+{
+    const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)colours));
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                            4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+    const __m256i byteIndex = _mm256_setr_epi8(0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3,
+                                               0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3);
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        // Put the same 8 shades in both lanes so each lane can pick out its own 4
+        __m256i index = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)(shades + x)));
+        index = _mm256_shuffle_epi8(index, spread);
+        index = _mm256_add_epi8(_mm256_slli_epi16(index, 2), byteIndex);
+        _mm256_storeu_si256((__m256i*)(out + x), _mm256_shuffle_epi8(table, index));
+    }
+
+    MapColoursScalar(colours, shades + x, out + x, count - x);
+}
+
+__attribute__((target("ssse3")))
+static void ComposeSSSE3(const uint8_t* table, const uint8_t* bg, const uint8_t* obj, const uint8_t* objAttributes, uint8_t* out, int count)
+{
+    const __m128i shades = _mm_loadu_si128((const __m128i*)table);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i priorityBit = _mm_set1_epi8((char)0x80);
+    const __m128i paletteBit = _mm_set1_epi8(0x10);
+    const __m128i four = _mm_set1_epi8(4);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i*)(bg + x));
+        __m128i o = _mm_loadu_si128((const __m128i*)(obj + x));
+        __m128i a = _mm_loadu_si128((const __m128i*)(objAttributes + x));
+
+        // visible = obj != 0 && (!priority || bg == 0)
+        __m128i objClear = _mm_cmpeq_epi8(o, zero);
+        __m128i behind = _mm_cmpeq_epi8(_mm_and_si128(a, priorityBit), priorityBit);
+        __m128i shown = _mm_or_si128(_mm_andnot_si128(behind, _mm_set1_epi8(-1)), _mm_cmpeq_epi8(b, zero));
+        __m128i visible = _mm_andnot_si128(objClear, shown);
+
+        // Sprite colours index 4-7 (OBP0) or 8-11 (OBP1) of the table
+        __m128i obp1 = _mm_cmpeq_epi8(_mm_and_si128(a, paletteBit), paletteBit);
+        __m128i objIndex = _mm_or_si128(o, _mm_add_epi8(four, _mm_and_si128(obp1, four)));
+
+        __m128i index = _mm_or_si128(_mm_and_si128(visible, objIndex), _mm_andnot_si128(visible, b));
+        _mm_storeu_si128((__m128i*)(out + x), _mm_shuffle_epi8(shades, index));
+    }
+
+    ComposeScalar(table, bg + x, obj + x, objAttributes + x, out + x, count - x);
+}
+
+__attribute__((target("avx2")))
+static void ComposeAVX2(const uint8_t* table, const uint8_t* bg, const uint8_t* obj, const uint8_t* objAttributes, uint8_t* out, int count)
+{
+    // vpshufb works within each 128 bit lane, so the table goes in both lanes
+    const __m256i shades = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)table));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i priorityBit = _mm256_set1_epi8((char)0x80);
+    const __m256i paletteBit = _mm256_set1_epi8(0x10);
+    const __m256i four = _mm256_set1_epi8(4);
+
+    int x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m256i b = _mm256_loadu_si256((const __m256i*)(bg + x));
+        __m256i o = _mm256_loadu_si256((const __m256i*)(obj + x));
+        __m256i a = _mm256_loadu_si256((const __m256i*)(objAttributes + x));
+
+        __m256i objClear = _mm256_cmpeq_epi8(o, zero);
+        __m256i behind = _mm256_cmpeq_epi8(_mm256_and_si256(a, priorityBit), priorityBit);
+        __m256i shown = _mm256_or_si256(_mm256_andnot_si256(behind, _mm256_set1_epi8(-1)), _mm256_cmpeq_epi8(b, zero));
+        __m256i visible = _mm256_andnot_si256(objClear, shown);
+
+        __m256i obp1 = _mm256_cmpeq_epi8(_mm256_and_si256(a, paletteBit), paletteBit);
+        __m256i objIndex = _mm256_or_si256(o, _mm256_add_epi8(four, _mm256_and_si256(obp1, four)));
+
+        __m256i index = _mm256_blendv_epi8(b, objIndex, visible);
+        _mm256_storeu_si256((__m256i*)(out + x), _mm256_shuffle_epi8(shades, index));
+    }
+
+    ComposeScalar(table, bg + x, obj + x, objAttributes + x, out + x, count - x);
+}
+#endif
+
+PixelPipeline::PixelPipeline()
+{
+    static bool initialised = (Init(), true);
+    (void)initialised;
+
+    bgp = 0;
+    obp0 = 0;
+    obp1 = 0;
+    memset(paletteTable, 0, sizeof(paletteTable));
+    memset(colourTable, 0, sizeof(colourTable));
+}
+
+PixelPipeline::~PixelPipeline()
+{
+}
+
+void PixelPipeline::Init()
+{
+    // Spreads the bits of a byte out into 8 bytes, bit 7 going into the first byte in memory (little endian)
+    for (int i = 0; i < 256; i++)
+    {
+        uint64_t spread = 0;
+        for (int x = 0; x < 8; x++)
+        {
+            spread |= (uint64_t)(i >> (7 - x) & 1) << (x * 8);
+        }
+        spreadTable[i] = spread;
+    }
+
+    compose = ComposeScalar;
+    mapColours = MapColoursScalar;
+    composeName = "scalar";
+
+#ifdef PIXELPIPELINE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        compose = ComposeAVX2;
+        mapColours = MapColoursAVX2;
+        composeName = "AVX2";
+    }
+    else if (__builtin_cpu_supports("ssse3"))
+    {
+        compose = ComposeSSSE3;
+        mapColours = MapColoursSSSE3;
+        composeName = "SSSE3";
+    }
+#endif
+}
+
+void PixelPipeline::DecodeTileRow(uint8_t low, uint8_t high, uint8_t* out)
+{
+    uint64_t row = spreadTable[low] | spreadTable[high] << 1;
+    memcpy(out, &row, 8);
+}
+
+void PixelPipeline::SetPalettes(uint8_t bgp, uint8_t obp0, uint8_t obp1)
+{
+    if (bgp == this->bgp && obp0 == this->obp0 && obp1 == this->obp1)
+    {
+        return;
+    }
+
+    this->bgp = bgp;
+    this->obp0 = obp0;
+    this->obp1 = obp1;
+
+    for (int i = 0; i < 4; i++)
+    {
+        paletteTable[i] = bgp >> i * 2 & 0x3;
+        paletteTable[4 + i] = obp0 >> i * 2 & 0x3;
+        paletteTable[8 + i] = obp1 >> i * 2 & 0x3;
+    }
+}
+
+void PixelPipeline::ComposeLine(const uint8_t* bg, const uint8_t* obj, const uint8_t* objAttributes, uint8_t* out, int count)
+{
+    compose(paletteTable, bg, obj, objAttributes, out, count);
+}
+
+void PixelPipeline::SetColours(const uint32_t* colours)
+{
+    memcpy(colourTable, colours, sizeof(colourTable));
+}
+
+void PixelPipeline::MapColours(const uint8_t* shades, uint32_t* out, int count)
+{
+    mapColours(colourTable, shades, out, count);
+}
+
+const char* PixelPipeline::GetName()
+{
+    return composeName;
+}
+
+/** @brief Switches composition and colour mapping to the named version, so tests can check
+ * they all agree. It's shared by every PixelPipeline.
+ *
+ * @param version const char* "scalar", "SSSE3" or "AVX2"
+ * @return false if the CPU can't run it, leaving the version as it was
+ *
+ */
+bool PixelPipeline::UseVersion(const char* version)
+{
+    if (strcmp(version, "scalar") == 0)
+    {
+        compose = ComposeScalar;
+        mapColours = MapColoursScalar;
+        composeName = "scalar";
+        return true;
+    }
+#ifdef PIXELPIPELINE_X86
+    if (strcmp(version, "SSSE3") == 0 && __builtin_cpu_supports("ssse3"))
+    {
+        compose = ComposeSSSE3;
+        mapColours = MapColoursSSSE3;
+        composeName = "SSSE3";
+        return true;
+    }
+    if (strcmp(version, "AVX2") == 0 && __builtin_cpu_supports("avx2"))
+    {
+        compose = ComposeAVX2;
+        mapColours = MapColoursAVX2;
+        composeName = "AVX2";
+        return true;
+    }
+#endif
+    return false;
+}
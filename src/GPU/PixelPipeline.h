@@ -0,0 +1,87 @@
+#ifndef PIXELPIPELINE_H
+#define PIXELPIPELINE_H
+
+#include <stdint.h>
+
+/** @brief Decodes tile data and composes scanlines
+ * Composition (priority + palettes) has SSSE3 and AVX2 versions that handle 16/32 pixels at once.
+ * The best version the CPU supports is picked the first time a PixelPipeline is created,
+ * with a scalar version used everywhere else.
+ */
+class PixelPipeline
+{
+public:
+    PixelPipeline();
+    virtual ~PixelPipeline();
+
+    /** @brief Interleaves the 2 bitplanes of a tile row into 8 colour numbers (0-3)
+     *
+     * @param low uint8_t First byte of the row (bit 0 of each colour)
+     * @param high uint8_t Second byte of the row (bit 1 of each colour)
+     * @param out uint8_t* 8 colour numbers, leftmost pixel first
+     * @return void
+     *
+     */
+    void DecodeTileRow(uint8_t low, uint8_t high, uint8_t* out);
+
+    /** @brief Sets the palettes used by ComposeLine
+     * The shuffle table is only rebuilt when one of the palettes has changed.
+     *
+     * @return void
+     *
+     */
+    void SetPalettes(uint8_t bgp, uint8_t obp0, uint8_t obp1);
+
+    /** @brief Combines background and sprite colour numbers into shades (0-3)
+     *
+     * @param bg const uint8_t* Background/window colour numbers
+     * @param obj const uint8_t* Sprite colour numbers, 0 where there is no sprite
+     * @param objAttributes const uint8_t* OAM attributes of the sprite at each pixel
+     * @param out uint8_t* Shades after the palettes have been applied
+     * @param count int Number of pixels
+     * @return void
+     *
+     */
+    void ComposeLine(const uint8_t* bg, const uint8_t* obj, const uint8_t* objAttributes, uint8_t* out, int count);
+
+    /** @brief Sets the 4 colours (ARGB8888) used by MapColours, lightest shade first
+     *
+     * @return void
+     *
+     */
+    void SetColours(const uint32_t* colours);
+
+    /** @brief Converts shades (0-3) into ARGB8888 pixels using the colour table
+     *
+     * @param shades const uint8_t*
+     * @param out uint32_t*
+     * @param count int Number of pixels
+     * @return void
+     *
+     */
+    void MapColours(const uint8_t* shades, uint32_t* out, int count);
+
+    const char* GetName(); // Name of the composition version in use
+    bool UseVersion(const char* version); // Switches every PixelPipeline to a version by name for tests, false if the CPU can't run it
+
+private:
+    typedef void (*ComposeFunc)(const uint8_t* table, const uint8_t* bg, const uint8_t* obj, const uint8_t* objAttributes, uint8_t* out, int count);
+    typedef void (*MapFunc)(const uint32_t* colours, const uint8_t* shades, uint32_t* out, int count);
+
+    static ComposeFunc compose;
+    static MapFunc mapColours;
+    static const char* composeName;
+    static uint64_t spreadTable[256];
+
+    static void Init();
+
+    // Shade for each colour: 0-3 BGP, 4-7 OBP0, 8-11 OBP1
+    uint8_t paletteTable[16];
+    uint8_t bgp;
+    uint8_t obp0;
+    uint8_t obp1;
+
+    uint32_t colourTable[4];
+};
+
+#endif // PIXELPIPELINE_H
@@ -0,0 +1,108 @@
+#include "RenderWorker.h"
+
+#include <string.h>
+
+using namespace std;
+
+RenderWorker::RenderWorker()
+{
+    memset(&snapshot, 0, sizeof(snapshot));
+    for (int i = 0; i < Renderer::VramPages; i++)
+    {
+        vramPages[i] = &snapshot.vram[i * PagedMemory::PageSize];
+    }
+    memset(frameBuffer, 0, sizeof(frameBuffer));
+    jobPending = false;
+    submitted = false;
+    running = false;
+}
+
+RenderWorker::~RenderWorker()
+{
+    if (workerThread.joinable())
+    {
+        {
+            lock_guard<mutex> lock(jobMutex);
+            running = false;
+        }
+        jobSignal.notify_all();
+        workerThread.join();
+    }
+}
+
+void RenderWorker::Submit(const uint8_t* const* vram, const uint8_t* oam, const LineRegisters* lines, bool* tileDirty, const uint32_t* colours)
+{
+    // The thread is only started once it's needed, most GPUs never draw this way
+    if (!workerThread.joinable())
+    {
+        running = true;
+        workerThread = thread(&RenderWorker::WorkerLoop, this);
+    }
+
+    {
+        lock_guard<mutex> lock(jobMutex);
+        for (int i = 0; i < Renderer::VramPages; i++)
+        {
+            memcpy(&snapshot.vram[i * PagedMemory::PageSize], vram[i], PagedMemory::PageSize);
+        }
+        memcpy(snapshot.oam, oam, sizeof(snapshot.oam));
+        memcpy(snapshot.lines, lines, sizeof(snapshot.lines));
+        for (int i = 0; i < Renderer::TileCount; i++)
+        {
+            snapshot.tileDirty[i] |= tileDirty[i];
+            tileDirty[i] = false;
+        }
+        memcpy(snapshot.colours, colours, sizeof(snapshot.colours));
+        jobPending = true;
+        submitted = true;
+    }
+    jobSignal.notify_all();
+}
+
+bool RenderWorker::Finish()
+{
+    if (!submitted)
+    {
+        return false;
+    }
+
+    unique_lock<mutex> lock(jobMutex);
+    jobSignal.wait(lock, [this] { return !jobPending; });
+    submitted = false;
+    return true;
+}
+
+const uint32_t* RenderWorker::GetFrameBuffer()
+{
+    return frameBuffer;
+}
+
+/** @brief Worker thread, draws each submitted snapshot
+ * The snapshot isn't touched by Submit until Finish has seen the frame is done, so it's
+ * read here without holding the lock.
+ *
+ * @return void
+ *
+ */
+void RenderWorker::WorkerLoop()
+{
+    unique_lock<mutex> lock(jobMutex);
+
+    while (true)
+    {
+        jobSignal.wait(lock, [this] { return jobPending || !running; });
+        if (!running)
+        {
+            return;
+        }
+
+        lock.unlock();
+        renderer.SetColours(snapshot.colours);
+        renderer.UpdateTiles(vramPages, snapshot.tileDirty);
+        renderer.RenderFrame(vramPages, snapshot.oam, snapshot.lines, frameBuffer);
+        lock.lock();
+
+        jobPending = false;
+        jobSignal.notify_all();
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef RENDERWORKER_H
+#define RENDERWORKER_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Renderer.h"
+
+/** @brief Draws frames on a worker thread from a snapshot of video memory
+ * The GPU submits a copy of VRAM, OAM and the latched line registers at VBlank and carries on
+ * with the next frame while the worker draws. The frame is collected at the next VBlank, so
+ * it's shown one frame later than it would be when drawing on the emulation thread.
+ */
+class RenderWorker
+{
+public:
+    RenderWorker();
+    virtual ~RenderWorker();
+
+    /** @brief Copies the state needed to draw a frame and wakes the worker
+     * Only one frame can be in progress, Finish must be called before the next Submit.
+     *
+     * @param vram const uint8_t* const* Pages of video RAM
+     * @param oam const uint8_t* Object attribute memory
+     * @param lines const LineRegisters* Registers latched for each line
+     * @param tileDirty bool* Tiles written since the last frame, cleared once copied
+     * @param colours const uint32_t* 4 ARGB colours for the shades
+     * @return void
+     *
+     */
+    void Submit(const uint8_t* const* vram, const uint8_t* oam, const LineRegisters* lines, bool* tileDirty, const uint32_t* colours);
+
+    bool Finish(); // Waits for the submitted frame, returns false if nothing was submitted
+    const uint32_t* GetFrameBuffer(); // The last finished frame
+
+private:
+    // Everything the worker reads while drawing, so the GPU can keep changing its own copy
+    struct Snapshot
+    {
+        uint8_t vram[MemorySizes.VIDEO_RAM_SIZE];
+        uint8_t oam[MemorySizes.OAM_SIZE];
+        LineRegisters lines[Renderer::ScreenHeight];
+        bool tileDirty[Renderer::TileCount];
+        uint32_t colours[4];
+    };
+
+    Snapshot snapshot;
+    const uint8_t* vramPages[Renderer::VramPages]; // Into the snapshot
+    Renderer renderer;
+    uint32_t frameBuffer[Renderer::ScreenWidth * Renderer::ScreenHeight];
+
+    std::thread workerThread;
+    std::mutex jobMutex;
+    std::condition_variable jobSignal;
+    bool jobPending; // Set by Submit, cleared by the worker when the frame has been drawn
+    bool submitted; // Set by Submit, cleared by Finish
+    bool running;
+
+    void WorkerLoop();
+};
+
+#endif // RENDERWORKER_H
@@ -0,0 +1,280 @@
+#include "Renderer.h"
+
+#include <string.h>
+
+Renderer::Renderer()
+{
+    lineSpriteCount = 0;
+    memset(tiles, 0, sizeof(tiles));
+}
+
+Renderer::~Renderer()
+{
+}
+
+void Renderer::SetColours(const uint32_t* colours)
+{
+    pipeline.SetColours(colours);
+}
+
+/** @brief Draws a whole frame from the registers latched for each line
+ * The tiles have to be up to date with vram before this is called.
+ *
+ * @return void
+ *
+ */
+void Renderer::RenderFrame(const uint8_t* const* vram, const uint8_t* oam, const LineRegisters* lines, uint32_t* frameBuffer)
+{
+    for (int line = 0; line < ScreenHeight; line++)
+    {
+        RenderScanLine(vram, oam, lines[line], line, frameBuffer);
+    }
+}
+
+void Renderer::RenderScanLine(const uint8_t* const* vram, const uint8_t* oam, const LineRegisters& regs, uint8_t line, uint32_t* frameBuffer)
+{
+    RenderBgLine(vram, regs, line);
+    RenderWindowLine(vram, regs, line);
+    RenderOAMLine(oam, regs, line);
+
+    pipeline.SetPalettes(regs.BGPalette, regs.ObjPalette0, regs.ObjPalette1);
+    pipeline.ComposeLine(bgColours, objColours, objAttributes, lineShades, ScreenWidth);
+    pipeline.MapColours(lineShades, &frameBuffer[line * ScreenWidth], ScreenWidth);
+}
+
+void Renderer::RenderBgLine(const uint8_t* const* vram, const LineRegisters& regs, uint8_t line)
+{
+    if (!regs.BackgroundEnabled())
+    {
+        // Background (and window) are blank, sprites are still drawn on top
+        for (int x = 0; x < ScreenWidth; x++)
+        {
+            bgColours[x] = 0;
+        }
+        return;
+    }
+
+    uint8_t row = regs.ScrollY + line;
+    RenderTiles(vram, regs, regs.GetBgTileMapAddress() + (row >> 3) * 32, regs.ScrollX, row, -(regs.ScrollX & 0x7));
+}
+
+void Renderer::RenderWindowLine(const uint8_t* const* vram, const LineRegisters& regs, uint8_t line)
+{
+    if (!regs.WindowVisible(line))
+    {
+        return;
+    }
+
+    uint16_t tileMapAddress = regs.GetWindowTileMapAddress() + (regs.WindowLine >> 3) * 32;
+    RenderTiles(vram, regs, tileMapAddress, 0, regs.WindowLine, regs.WinPosX - 7);
+}
+
+/** @brief Draws a row of tiles into bgColours
+ * Tiles are read from a 32 tile wide row of a tile map, wrapping around at the end of the row.
+ *
+ * @param vram const uint8_t* const* Pages of video RAM holding the tile maps
+ * @param regs const LineRegisters& Registers of the line being drawn
+ * @param tileMapAddress uint16_t Address of the first tile of the tile map row
+ * @param mapX uint8_t X pixel within the tile map row to start drawing from
+ * @param row uint8_t Y pixel within the tile map (only the row within the tile is used)
+ * @param startX int Screen X of the first pixel of the first tile, can be negative
+ * @return void
+ *
+ */
+void Renderer::RenderTiles(const uint8_t* const* vram, const LineRegisters& regs, uint16_t tileMapAddress, uint8_t mapX, uint8_t row, int startX)
+{
+    uint8_t tileColumn = mapX >> 3;
+    const uint8_t* tileMap = vram[(tileMapAddress & 0x1FFF) >> 8] + (tileMapAddress & 0xFF);
+    row &= 0x7;
+
+    for (int x = startX; x < ScreenWidth; x += 8)
+    {
+        const uint8_t* tileRow = tiles[regs.GetTileIndex(tileMap[tileColumn])][row];
+
+        if (x >= 0 && x + 8 <= ScreenWidth)
+        {
+            memcpy(&bgColours[x], tileRow, 8);
+            tileColumn = (tileColumn + 1) & 0x1F;
+            continue;
+        }
+
+        for (int tileX = 0; tileX < 8; tileX++)
+        {
+            if (x + tileX < 0)
+            {
+                continue;
+            }
+            else if (x + tileX >= ScreenWidth)
+            {
+                break;
+            }
+
+            bgColours[x + tileX] = tileRow[tileX];
+        }
+
+        tileColumn = (tileColumn + 1) & 0x1F;
+    }
+}
+
+void Renderer::UpdateTiles(const uint8_t* const* vram, bool* tileDirty)
+{
+    for (int i = 0; i < TileCount; i++)
+    {
+        if (tileDirty[i])
+        {
+            DecodeTile(vram, i);
+            tileDirty[i] = false;
+        }
+    }
+}
+
+/** @brief Decodes the 2 bitplanes of a tile into colour numbers
+ *
+ * @param vram const uint8_t* const* Pages of video RAM to decode from
+ * @param tile int Index of the tile (0-383)
+ * @return void
+ *
+ */
+void Renderer::DecodeTile(const uint8_t* const* vram, int tile)
+{
+    const uint8_t* data = vram[tile >> 4] + (tile & 0xF) * 16;
+
+    for (int row = 0; row < 8; row++)
+    {
+        pipeline.DecodeTileRow(data[row * 2], data[row * 2 + 1], tiles[tile][row]);
+    }
+}
+
+/** @brief Selects the sprites to be drawn on the current line
+ * Like the hardware, only the first 10 sprites in OAM that overlap the line are used,
+ * even if they are off screen horizontally. The list is sorted into drawing priority:
+ * lowest X first and lowest OAM index first when the X positions are the same.
+ *
+ * @return void
+ *
+ */
+void Renderer::ScanOAMLine(const uint8_t* oam, const LineRegisters& regs, uint8_t line)
+{
+    int height = regs.ObjectSize() ? 16 : 8;
+    lineSpriteCount = 0;
+
+    for (int i = 0; i < MemorySizes.OAM_SIZE && lineSpriteCount < MaxSpritesPerLine; i += 4)
+    {
+        int row = line + 16 - oam[i];
+        if (row < 0 || row >= height)
+        {
+            continue;
+        }
+
+        LineSprite sprite;
+        sprite.x = oam[i + 1];
+        sprite.tile = height == 16 ? oam[i + 2] & 0xFE : oam[i + 2];
+        sprite.attributes = oam[i + 3];
+        sprite.row = (sprite.attributes & 0x40) ? height - 1 - row : row;
+
+        // Insertion sort, sprites found later in OAM lose ties on X
+        int pos = lineSpriteCount;
+        while (pos > 0 && lineSprites[pos - 1].x > sprite.x)
+        {
+            lineSprites[pos] = lineSprites[pos - 1];
+            pos--;
+        }
+        lineSprites[pos] = sprite;
+        lineSpriteCount++;
+    }
+}
+
+void Renderer::RenderOAMLine(const uint8_t* oam, const LineRegisters& regs, uint8_t line)
+{
+    memset(objColours, 0, sizeof(objColours));
+    memset(objAttributes, 0, sizeof(objAttributes));
+
+    if (!regs.ObjectEnabled())
+    {
+        return;
+    }
+
+    ScanOAMLine(oam, regs, line);
+
+    // Draw the lowest priority sprite first so higher priority sprites overwrite it
+    for (int i = lineSpriteCount - 1; i >= 0; i--)
+    {
+        const LineSprite& sprite = lineSprites[i];
+
+        // Sprite tiles always use 0x8000-0x8FFF, 8x16 sprites continue into the next tile
+        const uint8_t* tileRow = tiles[sprite.tile + (sprite.row >> 3)][sprite.row & 0x7];
+
+        for (int tileX = 0; tileX < 8; tileX++)
+        {
+            int x = sprite.x - 8 + tileX;
+            if (x < 0 || x >= ScreenWidth)
+            {
+                continue;
+            }
+
+            uint8_t colour = tileRow[(sprite.attributes & 0x20) ? 7 - tileX : tileX];
+
+            // Colour 0 is transparent
+            if (colour != 0)
+            {
+                objColours[x] = colour;
+                objAttributes[x] = sprite.attributes;
+            }
+        }
+    }
+}
+
+uint16_t LineRegisters::GetWindowTileMapAddress() const
+{
+    if (LCDC >> 6 & 1) // Shift bit 6 to bit 0 and make sure it's the only value
+        return 0x9C00;
+    else
+        return 0x9800;
+}
+
+bool LineRegisters::WindowEnabled() const
+{
+    return LCDC >> 5 & 1;
+}
+
+bool LineRegisters::WindowVisible(uint8_t line) const
+{
+    // The window is drawn from WX - 7 and only once LY has reached WY
+    return BackgroundEnabled() && WindowEnabled() && line >= WinPosY && WinPosX <= 166;
+}
+
+uint16_t LineRegisters::GetBgTileMapAddress() const
+{
+    return (LCDC >> 3 & 1) == 0 ? 0x9800 : 0x9C00;
+}
+
+/** @brief Gets the index into the decoded tile cache for a tile number from a tile map
+ * With LCDC bit 4 clear, tile numbers are signed and relative to 0x9000.
+ *
+ * @param tileNum uint8_t
+ * @return uint16_t
+ *
+ */
+uint16_t LineRegisters::GetTileIndex(uint8_t tileNum) const
+{
+    if ((LCDC >> 4 & 1) == 0)
+    {
+        return 256 + (int8_t)tileNum;
+    }
+    return tileNum;
+}
+
+bool LineRegisters::ObjectSize() const
+{
+    return LCDC >> 2 & 1;
+}
+
+bool LineRegisters::ObjectEnabled() const
+{
+    return LCDC >> 1 & 1;
+}
+
+bool LineRegisters::BackgroundEnabled() const
+{
+    return LCDC & 1;
+}
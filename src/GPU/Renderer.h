@@ -0,0 +1,97 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <stdint.h>
+#include "IMemoryDevice.h"
+#include "Memory/PagedMemory.h"
+#include "PixelPipeline.h"
+
+// The registers that affect drawing, latched for each line
+struct LineRegisters
+{
+    uint8_t LCDC;
+    uint8_t ScrollY;
+    uint8_t ScrollX;
+    uint8_t BGPalette;
+    uint8_t ObjPalette0;
+    uint8_t ObjPalette1;
+    uint8_t WinPosY;
+    uint8_t WinPosX;
+    uint8_t WindowLine; // Row of the window drawn on this line, counted by the GPU
+
+    // Functions to obtain information from LCDC 0xFF40
+    uint16_t GetWindowTileMapAddress() const;
+    bool WindowEnabled() const;
+    bool WindowVisible(uint8_t line) const; // Whether any of the window is drawn on the line
+    uint16_t GetTileIndex(uint8_t tileNum) const;
+    uint16_t GetBgTileMapAddress() const; // 9800-9BFF if off, 9C00-9FFF if on
+    bool ObjectSize() const; // False = 8x8, True = 8x16
+    bool ObjectEnabled() const;
+    bool BackgroundEnabled() const; // bit 0
+};
+
+/** @brief Draws lines from VRAM, OAM and a line's registers into a frame buffer
+ * The renderer keeps its own decoded copy of the tile data, so it doesn't need the GPU
+ * and can draw from a snapshot of video memory on another thread. VRAM is passed as its
+ * table of 256 byte pages, tiles and tile map rows never cross a page.
+ */
+class Renderer
+{
+public:
+    Renderer();
+    virtual ~Renderer();
+
+    static const int ScreenWidth = 160;
+    static const int ScreenHeight = 144;
+    static const int TileCount = 384; // 0x8000-0x97FF, 16 bytes per tile
+    static const int VramPages = MemorySizes.VIDEO_RAM_SIZE / PagedMemory::PageSize;
+
+    void SetColours(const uint32_t* colours); // 4 ARGB colours for the shades, lightest first
+
+    /** @brief Decodes the tiles that have been accessed since they were last decoded
+     *
+     * @param vram const uint8_t* const* Pages of video RAM to decode from
+     * @param tileDirty bool* TileCount flags, cleared as the tiles are decoded
+     * @return void
+     *
+     */
+    void UpdateTiles(const uint8_t* const* vram, bool* tileDirty);
+
+    void RenderScanLine(const uint8_t* const* vram, const uint8_t* oam, const LineRegisters& regs, uint8_t line, uint32_t* frameBuffer);
+    void RenderFrame(const uint8_t* const* vram, const uint8_t* oam, const LineRegisters* lines, uint32_t* frameBuffer);
+
+private:
+    // Tile data decoded into colour numbers (0-3), indexed [tile][row][x]
+    uint8_t tiles[TileCount][8][8];
+
+    static const int MaxSpritesPerLine = 10;
+
+    // A sprite selected by the OAM scan for the current line
+    struct LineSprite
+    {
+        uint8_t x; // Screen X + 8
+        uint8_t row; // Row of the sprite to draw on this line (flip already applied)
+        uint8_t tile;
+        uint8_t attributes;
+    };
+
+    LineSprite lineSprites[MaxSpritesPerLine]; // Sorted by drawing priority, highest first
+    uint8_t lineSpriteCount;
+
+    // Raw colour numbers (0-3) of the line being rendered, before palettes are applied
+    uint8_t bgColours[ScreenWidth];
+    uint8_t objColours[ScreenWidth]; // 0 = no sprite pixel
+    uint8_t objAttributes[ScreenWidth];
+    uint8_t lineShades[ScreenWidth]; // Composed line after the palettes are applied
+
+    PixelPipeline pipeline;
+
+    void RenderBgLine(const uint8_t* const* vram, const LineRegisters& regs, uint8_t line);
+    void RenderWindowLine(const uint8_t* const* vram, const LineRegisters& regs, uint8_t line);
+    void RenderOAMLine(const uint8_t* oam, const LineRegisters& regs, uint8_t line);
+    void ScanOAMLine(const uint8_t* oam, const LineRegisters& regs, uint8_t line);
+    void RenderTiles(const uint8_t* const* vram, const LineRegisters& regs, uint16_t tileMapAddress, uint8_t mapX, uint8_t row, int startX);
+    void DecodeTile(const uint8_t* const* vram, int tile);
+};
+
+#endif // RENDERER_H
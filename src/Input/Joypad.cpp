@@ -0,0 +1,85 @@
+#include "Joypad.h"
+
+Joypad::Joypad()
+{
+    buttons = 0;
+    Reset();
+}
+
+Joypad::~Joypad()
+{
+}
+
+void Joypad::Reset()
+{
+    select = 0x30;
+    readValue = 0xFF;
+}
+
+void Joypad::SetButton(JoypadButton button, bool pressed)
+{
+    if (pressed)
+        buttons |= (uint8_t)button;
+    else
+        buttons &= ~(uint8_t)button;
+}
+
+void Joypad::SetButtons(uint8_t buttons)
+{
+    this->buttons = buttons;
+}
+
+uint8_t Joypad::GetButtons()
+{
+    return buttons;
+}
+
+uint8_t* Joypad::GetMemoryPtr(uint16_t)
+{
+    uint8_t pressed = 0;
+    if (!(select & 0x10))
+    {
+        pressed |= buttons & 0x0F;
+    }
+    if (!(select & 0x20))
+    {
+        pressed |= buttons >> 4;
+    }
+
+    // Bits 6 and 7 aren't used and read as 1
+    readValue = 0xC0 | select | (~pressed & 0x0F);
+
+    // Writes go through WriteByte, writing through this pointer has no effect
+    return &readValue;
+}
+
+void Joypad::WriteByte(uint16_t, uint8_t data)
+{
+    select = data & 0x30;
+}
+
+void Joypad::SaveState(StateWriter& state)
+{
+    state.BeginSection(StateTag("JOYP"));
+    state.Write(select);
+    state.EndSection();
+}
+
+void Joypad::LoadState(StateReader& state)
+{
+    state.OpenSection(StateTag("JOYP"));
+    state.Read(select);
+}
+
+void Joypad::CheckState(StateReader& state)
+{
+    state.OpenSection(StateTag("JOYP"));
+    state.Skip(sizeof(select));
+    state.CloseSection();
+}
+
+void Joypad::ForkFrom(Joypad& parent)
+{
+    select = parent.select;
+    buttons = parent.buttons;
+}
@@ -0,0 +1,52 @@
+#ifndef JOYPAD_H
+#define JOYPAD_H
+
+#include <stdint.h>
+#include "Memory/IMemoryDevice.h"
+#include "State/StateStream.h"
+
+// Bits of the button state, the directions and the buttons in the order P1 reads them
+enum class JoypadButton
+{
+    Right = 0x01,
+    Left = 0x02,
+    Up = 0x04,
+    Down = 0x08,
+    A = 0x10,
+    B = 0x20,
+    Select = 0x40,
+    Start = 0x80,
+};
+
+/** @brief The joypad register, P1 (0xFF00)
+ * The game writes bits 4 and 5 to pick the directions and/or the buttons, and reads the
+ * picked ones back in the low 4 bits, 0 meaning pressed. Which buttons are held is set by
+ * the host once a frame, so it isn't part of the save state.
+ */
+class Joypad: public IMemoryDevice
+{
+public:
+    Joypad();
+    virtual ~Joypad();
+
+    void Reset();
+
+    void SetButton(JoypadButton button, bool pressed);
+    void SetButtons(uint8_t buttons); // JoypadButton bits
+    uint8_t GetButtons();
+
+    uint8_t* GetMemoryPtr(uint16_t address);
+    void WriteByte(uint16_t address, uint8_t data);
+
+    void SaveState(StateWriter& state);
+    void LoadState(StateReader& state);
+    void CheckState(StateReader& state); // Skips what LoadState reads, see Z80::LoadState
+    void ForkFrom(Joypad& parent); // Including the held buttons, until the fork is given its own
+
+private:
+    uint8_t buttons; // Held buttons, JoypadButton bits
+    uint8_t select; // Bits 4 and 5 as written, 0 selects
+    uint8_t readValue;
+};
+
+#endif // JOYPAD_H
@@ -12,11 +12,16 @@ uint16_t IMemoryDevice::ReadWord(uint16_t address)
 
 void IMemoryDevice::WriteByte(uint16_t address, uint8_t data)
 {
-    *GetMemoryPtr(address) = data;
+    *GetWritePtr(address) = data;
+}
+
+uint8_t* IMemoryDevice::GetWritePtr(uint16_t address)
+{
+    return GetMemoryPtr(address);
 }
 
 void IMemoryDevice::WriteWord(uint16_t address, uint16_t data)
 {
-    *GetMemoryPtr(address) = data & 0x00FF;
-    *GetMemoryPtr(address + 1) = data >> 8 & 0x00FF;
+    WriteByte(address, data & 0x00FF);
+    WriteByte(address + 1, data >> 8 & 0x00FF);
 }
@@ -94,10 +94,11 @@ public:
 
     uint8_t     ReadByte(uint16_t address);
     uint16_t    ReadWord(uint16_t address);
-    void        WriteByte(uint16_t address, uint8_t data);
+    virtual void WriteByte(uint16_t address, uint8_t data); // Devices with registers that act on writes override this
     void        WriteWord(uint16_t address, uint16_t data);
 
     virtual uint8_t* GetMemoryPtr(uint16_t address) = 0;
+    virtual uint8_t* GetWritePtr(uint16_t address); // For writing through, devices with memory shared between forks override this
 protected:
 private:
 };
@@ -1,12 +1,19 @@
 #include "MMU.h"
 #include <fstream>
 #include <iostream>
+#include <string.h>
+#include "Util/Hash.h"
 
 //#include <stdio.h>
 
-MMU::MMU(GPU* gpu)
+MMU::MMU(GPU* gpu, APU* apu, Joypad* joypad) :
+    rom(MemorySizes.ROM_CARTRIDGE_SIZE), wram(MemorySizes.WORKING_RAM_SIZE), eram(MemorySizes.EXTERNAL_RAM_SIZE)
 {
     this->gpu = gpu;
+    this->apu = apu;
+    this->joypad = joypad;
+    memset(hram, 0, sizeof(hram));
+    romHash = HashRom();
     Reset();
 }
 
@@ -23,6 +30,7 @@ void MMU::Reset()
 void MMU::LoadRom(string romPath)
 {
     int romSize;
+    uint8_t data[MemorySizes.ROM_CARTRIDGE_SIZE] = {};
     ifstream romFile (romPath, ifstream::binary);
     if (romFile.is_open())
     {
@@ -34,22 +42,141 @@ void MMU::LoadRom(string romPath)
         {
             char byte;
             romFile.read(&byte, sizeof(char));
-            rom[i] = byte;
+            data[i] = byte;
         }
     }
     else
     {
         cout << "Unable to open rom file: " << romPath << endl;
     }
+    rom.Load(data, sizeof(data));
+    romHash = HashRom();
 }
 
-/** @brief Gets a pointer to a memory address to be accessed by Read/Write functions.
+uint64_t MMU::GetRomHash()
+{
+    return romHash;
+}
+
+void MMU::SaveState(StateWriter& state)
+{
+    state.BeginSection(StateTag("MMU "));
+    wram.SaveState(state);
+    eram.SaveState(state);
+    state.Write(hram);
+    state.Write(inBios);
+    state.Write(dummyVar);
+    state.EndSection();
+}
+
+void MMU::LoadState(StateReader& state)
+{
+    state.OpenSection(StateTag("MMU "));
+    wram.LoadState(state);
+    eram.LoadState(state);
+    state.Read(hram);
+    state.Read(inBios);
+    state.Read(dummyVar);
+}
+
+void MMU::CheckState(StateReader& state)
+{
+    state.OpenSection(StateTag("MMU "));
+    wram.CheckState(state);
+    eram.CheckState(state);
+    state.Skip(sizeof(hram));
+    state.Skip(sizeof(inBios));
+    state.Skip(sizeof(dummyVar));
+    state.CloseSection();
+}
+
+void MMU::ForkFrom(MMU& parent)
+{
+    rom.ShareFrom(parent.rom);
+    wram.ShareFrom(parent.wram);
+    eram.ShareFrom(parent.eram);
+    memcpy(hram, parent.hram, sizeof(hram));
+    inBios = parent.inBios;
+    dummyVar = parent.dummyVar;
+    romHash = parent.romHash;
+}
+
+void MMU::Unshare()
+{
+    // ROM is only shared with forks, which can keep sharing it
+    wram.Unshare();
+    eram.Unshare();
+}
+
+size_t MMU::GetPagesCopied()
+{
+    return rom.GetPagesCopied() + wram.GetPagesCopied() + eram.GetPagesCopied();
+}
+
+uint64_t MMU::HashRom()
+{
+    // The pages aren't contiguous, so they're put back together to hash
+    vector<uint8_t> data(rom.GetSize());
+    const uint8_t* const* pages = rom.GetPages();
+    for (size_t offset = 0; offset < data.size(); offset += PagedMemory::PageSize)
+    {
+        memcpy(&data[offset], pages[offset / PagedMemory::PageSize], PagedMemory::PageSize);
+    }
+    return Hash::Hash64(data.data(), data.size());
+}
+
+/** @brief Writes a byte, passing writes to the joypad and sound registers to their devices so they can act on them
+ *
+ * @param address The memory address being written.
+ * @param data The value to write.
+ * @return void
+ *
+ */
+void MMU::WriteByte(uint16_t address, uint8_t data)
+{
+    if (address == (uint16_t)IORegisters::P1)
+    {
+        joypad->WriteByte(address, data);
+    }
+    else if (address >= 0xFF10 && address < 0xFF40)
+    {
+        apu->WriteByte(address, data);
+    }
+    else
+    {
+        IMemoryDevice::WriteByte(address, data);
+    }
+}
+
+/** @brief Gets a pointer to a memory address to be read.
  *
  * @param address The memory address being accessed.
  * @return Pointer to the memory address.
  *
  */
 uint8_t* MMU::GetMemoryPtr(uint16_t address)
+{
+    return GetPtr(address, false);
+}
+
+/** @brief Gets a pointer to a memory address to be written.
+ * A page of memory shared with a fork is copied first.
+ *
+ * @param address The memory address being accessed.
+ * @return Pointer to the memory address.
+ *
+ */
+uint8_t* MMU::GetWritePtr(uint16_t address)
+{
+    return GetPtr(address, true);
+}
+
+static inline uint8_t* Access(PagedMemory& memory, size_t offset, bool write)
+{
+    return write ? memory.GetWritePtr(offset) : memory.GetPtr(offset);
+}
+
+inline uint8_t* MMU::GetPtr(uint16_t address, bool write)
 {
     switch (address & 0xF000)
     {
@@ -66,7 +193,7 @@ uint8_t* MMU::GetMemoryPtr(uint16_t address)
                 inBios = false;
             }
         }
-        return &rom[address];
+        return Access(rom, address, write);
 
     // ROM 0 (32k)
     case 0x1000:
@@ -76,26 +203,26 @@ uint8_t* MMU::GetMemoryPtr(uint16_t address)
     case 0x5000:
     case 0x6000:
     case 0x7000:
-        return &rom[address];
+        return Access(rom, address, write);
 
     // Video/Graphics RAM
     case 0x8000:
     case 0x9000:
-        return gpu->GetMemoryPtr(address);
+        return write ? gpu->GetWritePtr(address) : gpu->GetMemoryPtr(address);
 
     // External RAM
     case 0xA000:
     case 0xB000:
-        return &eram[address & 0x1FFF];
+        return Access(eram, address & 0x1FFF, write);
 
     // Working RAM
     case 0xC000:
     case 0xD000:
-        return &wram[address & 0x1FFF];
+        return Access(wram, address & 0x1FFF, write);
 
     // Working RAM shadow
     case 0xE000:
-        return &wram[address & 0x1FFF];
+        return Access(wram, address & 0x1FFF, write);
 
     case 0xF000:
         switch (address & 0x0F00)
@@ -114,11 +241,11 @@ uint8_t* MMU::GetMemoryPtr(uint16_t address)
         case 0xB00:
         case 0xC00:
         case 0xD00:
-            return &wram[address & 0x1FFF];
+            return Access(wram, address & 0x1FFF, write);
 
         // Sprite attribute memory (OAM)
         case 0xE00:
-            return gpu->GetMemoryPtr(address);
+            return write ? gpu->GetWritePtr(address) : gpu->GetMemoryPtr(address);
 
         // High RAM / Memory Mapped IO
         case 0xF00:
@@ -127,8 +254,19 @@ uint8_t* MMU::GetMemoryPtr(uint16_t address)
                 // Memory mapped IO
                 switch (address & 0x00F0)
                 {
+                case 0x00:
+                    if (address == (uint16_t)IORegisters::P1)
+                    {
+                        return joypad->GetMemoryPtr(address);
+                    }
+                    return &dummyVar;
+                // Sound registers and wave RAM
+                case 0x10:
+                case 0x20:
+                case 0x30:
+                    return apu->GetMemoryPtr(address);
                 case 0x40:
-                    return gpu->GetMemoryPtr(address);
+                    return write ? gpu->GetWritePtr(address) : gpu->GetMemoryPtr(address);
                 default:
                     printf("MEMORY ADDESS NOT FOUND: 0x%X\n", address);
                     return &dummyVar;
@@ -3,27 +3,45 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
+#include "Audio/APU.h"
 #include "GPU/GPU.h"
+#include "Input/Joypad.h"
 #include "Memory/IMemoryDevice.h"
+#include "Memory/PagedMemory.h"
+#include "State/StateStream.h"
 
 using namespace std;
 
 class MMU: public IMemoryDevice
 {
 public:
-    MMU(GPU* gpu);
+    MMU(GPU* gpu, APU* apu, Joypad* joypad);
     virtual ~MMU();
 
     uint8_t* GetMemoryPtr(uint16_t address);
+    uint8_t* GetWritePtr(uint16_t address);
+    void WriteByte(uint16_t address, uint8_t data);
 
     void Reset();
     void LoadRom(string romPath);
+    uint64_t GetRomHash(); // Identifies the ROM, so states and movies can't be used with the wrong one
+
+    void SaveState(StateWriter& state);
+    void LoadState(StateReader& state);
+    void CheckState(StateReader& state); // Skips what LoadState reads, see Z80::LoadState
+    void ForkFrom(MMU& parent); // Shares parent's ROM and RAM pages, copies the rest
+    void Unshare(); // Gives RAM its own copy of pages shared with forks or a mapped state
+    size_t GetPagesCopied(); // Copies made on write to ROM and RAM
 
 protected:
 private:
     GPU* gpu;
+    APU* apu;
+    Joypad* joypad;
 
     bool inBios = true;
+    uint64_t romHash;
 
     uint8_t bios[0x100] = // The official GameBoy BIOS
     {
@@ -35,7 +53,7 @@ private:
         0xF9, 0x2E, 0x0F, 0x18, 0xF3, 0x67, 0x3E, 0x64, 0x57, 0xE0, 0x42, 0x3E, 0x91, 0xE0, 0x40, 0x04,
         0x1E, 0x02, 0x0E, 0x0C, 0xF0, 0x44, 0xFE, 0x90, 0x20, 0xFA, 0x0D, 0x20, 0xF7, 0x1D, 0x20, 0xF2,
         0x0E, 0x13, 0x24, 0x7C, 0x1E, 0x83, 0xFE, 0x62, 0x28, 0x06, 0x1E, 0xC1, 0xFE, 0x64, 0x20, 0x06,
-        0x7B, 0xE2, 0x0C, 0x3E, 0x87, 0xF2, 0xF0, 0x42, 0x90, 0xE0, 0x42, 0x15, 0x20, 0xD2, 0x05, 0x20,
+        0x7B, 0xE2, 0x0C, 0x3E, 0x87, 0xE2, 0xF0, 0x42, 0x90, 0xE0, 0x42, 0x15, 0x20, 0xD2, 0x05, 0x20,
         0x4F, 0x16, 0x20, 0x18, 0xCB, 0x4F, 0x06, 0x04, 0xC5, 0xCB, 0x11, 0x17, 0xC1, 0xCB, 0x11, 0x17,
         0x05, 0x20, 0xF5, 0x22, 0x23, 0x22, 0x23, 0xC9, 0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B,
         0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D, 0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E,
@@ -45,11 +63,15 @@ private:
         0xF5, 0x06, 0x19, 0x78, 0x86, 0x23, 0x05, 0x20, 0xFB, 0x86, 0x20, 0xFE, 0x3E, 0x01, 0xE0, 0x50
     };
 
-    uint8_t rom[MemorySizes.ROM_CARTRIDGE_SIZE];
-    uint8_t wram[MemorySizes.EXTERNAL_RAM_SIZE];
-    uint8_t eram[MemorySizes.WORKING_RAM_SIZE];
+    // Shared with forks until written. High RAM is under a page, so it's just copied.
+    PagedMemory rom;
+    PagedMemory wram;
+    PagedMemory eram;
     uint8_t hram[MemorySizes.HIGH_RAM_SIZE];
 
     uint8_t dummyVar = 0; // @todo a placeholder to return a random reference for IO ports not implemented
+
+    uint8_t* GetPtr(uint16_t address, bool write);
+    uint64_t HashRom();
 };
 #endif // MMU_H
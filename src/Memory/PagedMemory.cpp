@@ -0,0 +1,206 @@
+#include "PagedMemory.h"
+
+#include <string.h>
+#include <algorithm>
+#include "Util/Hash.h"
+
+using namespace std;
+
+PagedMemory::PagedMemory(size_t size)
+{
+    size_t count = (size + PageSize - 1) / PageSize;
+    refs.resize(count);
+    pages.resize(count);
+    owned.resize(count);
+    writable.resize(count);
+    hashes.resize(count);
+    hashed.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        refs[i] = make_shared<Page>();
+        pages[i] = refs[i]->data;
+        owned[i] = true;
+        writable[i] = true;
+        hashed[i] = false;
+    }
+    pagesCopied = 0;
+    Fill(0);
+}
+
+PagedMemory::~PagedMemory()
+{
+}
+
+const uint8_t* const* PagedMemory::GetPages()
+{
+    return pages.data();
+}
+
+size_t PagedMemory::GetSize()
+{
+    return pages.size() * PageSize;
+}
+
+void PagedMemory::Fill(uint8_t value)
+{
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        if (!writable[i])
+        {
+            MakeWritable(i, false);
+        }
+        memset(pages[i], value, PageSize);
+    }
+}
+
+void PagedMemory::Load(const uint8_t* data, size_t size)
+{
+    size = min(size, GetSize());
+    for (size_t offset = 0; offset < size; offset += PageSize)
+    {
+        size_t page = offset / PageSize;
+        size_t count = min(size - offset, (size_t)PageSize);
+        if (!writable[page])
+        {
+            MakeWritable(page, count < PageSize);
+        }
+        memcpy(pages[page], data + offset, count);
+    }
+}
+
+void PagedMemory::ShareFrom(PagedMemory& parent)
+{
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        if (refs[i] != parent.refs[i])
+        {
+            refs[i] = parent.refs[i];
+            pages[i] = parent.pages[i];
+            hashes[i] = parent.hashes[i];
+            hashed[i] = parent.hashed[i];
+        }
+        owned[i] = false;
+        parent.owned[i] = false;
+        writable[i] = false;
+        parent.writable[i] = false;
+    }
+}
+
+void PagedMemory::Unshare()
+{
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        if (!owned[i])
+        {
+            MakeWritable(i, true);
+        }
+    }
+}
+
+size_t PagedMemory::GetPagesCopied()
+{
+    return pagesCopied;
+}
+
+void PagedMemory::SaveState(StateWriter& state)
+{
+    if (!state.IsHashing())
+    {
+        state.Align();
+        for (size_t i = 0; i < pages.size(); i++)
+        {
+            state.Write(pages[i], PageSize);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        if (!hashed[i])
+        {
+            hashes[i] = Hash::Hash64(pages[i], PageSize);
+            hashed[i] = true;
+            // The next write has to come through MakeWritable to mark the hash out of date
+            writable[i] = false;
+        }
+    }
+    state.Write(hashes.data(), hashes.size() * sizeof(uint64_t));
+}
+
+/** @brief Reads the bytes written by SaveState
+ * Pages that are already the same are left alone, so going back to a recent state (rewind,
+ * run-ahead) keeps most of the page hashes and doesn't copy pages shared with forks.
+ * A mapped state isn't read at all, the pages point into the mapping.
+ *
+ * @return void
+ *
+ */
+void PagedMemory::LoadState(StateReader& state)
+{
+    state.SkipPadding();
+    if (state.GetMapping())
+    {
+        // Z80::LoadState has already checked the section is long enough, so this only fails
+        // for a section that wasn't checked, which is left alone rather than zero filled
+        uint8_t* mapped = state.ReadMapped(GetSize());
+        if (mapped == NULL)
+        {
+            return;
+        }
+
+        // Every page holds a reference to the mapping, so it stays mapped while any are in use.
+        // They're shared like forked pages, and copied on write.
+        for (size_t i = 0; i < pages.size(); i++)
+        {
+            refs[i] = shared_ptr<Page>(state.GetMapping(), (Page*)(mapped + i * PageSize));
+            pages[i] = refs[i]->data;
+            owned[i] = false;
+            writable[i] = false;
+            hashed[i] = false;
+        }
+        return;
+    }
+
+    uint8_t page[PageSize];
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        state.Read(page, PageSize);
+        if (memcmp(page, pages[i], PageSize) != 0)
+        {
+            if (!writable[i])
+            {
+                MakeWritable(i, false);
+            }
+            memcpy(pages[i], page, PageSize);
+        }
+    }
+}
+
+void PagedMemory::CheckState(StateReader& state)
+{
+    state.SkipPadding();
+    state.Skip(GetSize());
+}
+
+/** @brief Gets a page ready to be written: gives this memory its own copy and marks its hash out of date
+ * A page that isn't owned is copied even if the others sharing it have since let it go.
+ * Finding that out would mean reading reference counts that other threads are changing,
+ * and it would only save one copy per page per fork.
+ *
+ * @param page size_t
+ * @param keep bool Whether the contents are needed, or are about to be overwritten
+ * @return void
+ *
+ */
+void PagedMemory::MakeWritable(size_t page, bool keep)
+{
+    if (!owned[page])
+    {
+        refs[page] = keep ? make_shared<Page>(*refs[page]) : make_shared<Page>();
+        pages[page] = refs[page]->data;
+        owned[page] = true;
+        pagesCopied++;
+    }
+    writable[page] = true;
+    hashed[page] = false;
+}
@@ -0,0 +1,92 @@
+#ifndef PAGEDMEMORY_H
+#define PAGEDMEMORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include "State/StateStream.h"
+
+/** @brief Memory split into 256 byte pages that forked machines share until one of them writes
+ * Forking copies the page table, and a page is only copied the first time a machine writes
+ * to it while it's shared, so forking costs the pages that get written rather than the size
+ * of the memory. Reads go through GetPtr and never copy, anything written has to go through
+ * GetWritePtr. Each memory keeps track of which pages it owns: pages it made itself, which
+ * nothing else can be holding. Forking takes ownership away from both sides, and a page that
+ * isn't owned is always copied before it's written, so machines running on different threads
+ * never have to look at each other's pages to decide. Pages are reference counted only so
+ * they're freed with the last memory using them.
+ * Each page also keeps its hash, which is only worked out again once the page has been
+ * written, so hashing the state costs the pages written since it was last hashed.
+ * Loading from a mapped state file shares the file's pages in the same way, so it doesn't
+ * copy anything until the pages are written.
+ */
+class PagedMemory
+{
+public:
+    static const int PageSize = 256;
+
+    PagedMemory(size_t size); // Zeroed
+    virtual ~PagedMemory();
+
+    inline uint8_t* GetPtr(size_t offset) // For reading only
+    {
+        return pages[offset >> 8] + (offset & 0xFF);
+    }
+
+    inline uint8_t* GetWritePtr(size_t offset)
+    {
+        size_t page = offset >> 8;
+        if (!writable[page])
+        {
+            MakeWritable(page, true);
+        }
+        return pages[page] + (offset & 0xFF);
+    }
+
+    const uint8_t* const* GetPages(); // Page table, for readers that work a page at a time
+    size_t GetSize();
+
+    void Fill(uint8_t value);
+    void Load(const uint8_t* data, size_t size); // Copies into the start of the memory
+
+    /** @brief Shares all of parent's pages, dropping this memory's own
+     * Neither side owns the pages afterwards, so both copy on their next write to one. Pages
+     * already shared with parent are skipped, so forking from the same parent again only costs
+     * the pages written since. The pages' hashes come along with them. Parent mustn't be
+     * running on another thread while this is called, the two can run on separate threads
+     * afterwards.
+     *
+     * @param parent PagedMemory& The same size as this
+     * @return void
+     *
+     */
+    void ShareFrom(PagedMemory& parent);
+
+    void Unshare(); // Copies every page that isn't owned, letting go of forks' pages and mapped files
+    size_t GetPagesCopied(); // Copies made on write since this memory was created
+
+    void SaveState(StateWriter& state); // Writes the bytes after StateWriter::Align, or the page hashes when hashing
+    void LoadState(StateReader& state);
+    void CheckState(StateReader& state); // Skips what LoadState reads
+
+private:
+    struct Page
+    {
+        uint8_t data[PageSize];
+    };
+
+    std::vector<std::shared_ptr<Page>> refs;
+    std::vector<uint8_t*> pages; // refs' data, to save a dereference on every access
+    std::vector<uint8_t> owned; // Made by this memory, so nothing else can hold the page
+    // Set when the page is owned and its hash is already out of date, so it can be written in
+    // place. Cleared by forking and by hashing the page.
+    std::vector<uint8_t> writable;
+    std::vector<uint64_t> hashes;
+    std::vector<uint8_t> hashed; // Whether the page's hash is up to date
+    size_t pagesCopied;
+
+    void MakeWritable(size_t page, bool keep); // Copies the page first if it isn't owned, keeping the contents if keep is set
+};
+
+#endif // PAGEDMEMORY_H
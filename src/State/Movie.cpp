@@ -0,0 +1,206 @@
+#include "Movie.h"
+
+#include <string.h>
+
+using namespace std;
+
+static const char Magic[4] = { 'W', 'G', 'B', 'M' };
+static const uint32_t Version = 2;
+
+Movie::Movie()
+{
+    file = NULL;
+    playing = false;
+    frame = 0;
+    desyncFrame = -1;
+    error = "";
+    memset(&header, 0, sizeof(header));
+}
+
+Movie::~Movie()
+{
+    Close();
+}
+
+bool Movie::Record(const char* path, Z80* z80)
+{
+    Close();
+
+    file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return Fail("Couldn't create the file");
+    }
+
+    state.Save(z80);
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.romHash = z80->GetMMU()->GetRomHash();
+    header.frames = 0;
+    header.stateSize = state.GetData().size();
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(state.GetData().data(), 1, state.GetData().size(), file);
+
+    frame = 0;
+    desyncFrame = -1;
+    Step(z80, z80->GetJoypad()->GetButtons());
+    return true;
+}
+
+bool Movie::Play(const char* path, Z80* z80)
+{
+    Close();
+
+    FILE* input = fopen(path, "rb");
+    if (input == NULL)
+    {
+        return Fail("Couldn't open the file");
+    }
+    fseek(input, 0, SEEK_END);
+    long size = ftell(input);
+    fseek(input, 0, SEEK_SET);
+    vector<uint8_t> data(size > 0 ? size : 0);
+    bool read = fread(data.data(), 1, data.size(), input) == data.size();
+    fclose(input);
+    if (!read)
+    {
+        return Fail("Couldn't read the file");
+    }
+
+    if (data.size() < sizeof(header) || memcmp(data.data(), Magic, sizeof(Magic)) != 0)
+    {
+        return Fail("Not a WolfGB movie");
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.version != Version)
+    {
+        return Fail("Movie is from another version of WolfGB");
+    }
+    if (header.romHash != z80->GetMMU()->GetRomHash())
+    {
+        return Fail("Movie is for another ROM");
+    }
+    size_t recordsStart = sizeof(header) + header.stateSize;
+    size_t recordsSize = ((size_t)header.frames + 1) * RecordSize;
+    if (data.size() < recordsStart + recordsSize)
+    {
+        return Fail("Movie is cut short");
+    }
+
+    records.assign(data.begin() + recordsStart, data.begin() + recordsStart + recordsSize);
+    state.SetData(vector<uint8_t>(data.begin() + sizeof(header), data.begin() + recordsStart));
+    if (!state.Load(z80))
+    {
+        return Fail(state.GetError());
+    }
+
+    playing = true;
+    frame = 0;
+    desyncFrame = -1;
+    Step(z80, 0);
+    return true;
+}
+
+/** @brief Handles the record for the frame about to start
+ * Record and Play handle frame 0's. A movie of n frames has n + 1 records, the last one is
+ * only there for its hash of the state the run ended in.
+ *
+ * @return false on the frame a desync is found
+ *
+ */
+bool Movie::Step(Z80* z80, uint8_t buttons)
+{
+    Joypad* joypad = z80->GetJoypad();
+
+    if (file != NULL)
+    {
+        uint64_t hash = z80->HashState();
+        joypad->SetButtons(buttons);
+        fwrite(&buttons, 1, 1, file);
+        fwrite(&hash, sizeof(hash), 1, file);
+        return true;
+    }
+
+    const uint8_t* record = &records[(size_t)frame * RecordSize];
+    uint64_t hash;
+    memcpy(&hash, record + 1, sizeof(hash));
+
+    bool synced = desyncFrame >= 0 || z80->HashState() == hash;
+    if (!synced)
+    {
+        desyncFrame = frame;
+    }
+
+    if (frame == header.frames)
+    {
+        playing = false;
+        joypad->SetButtons(buttons);
+    }
+    else
+    {
+        joypad->SetButtons(record[0]);
+    }
+    return synced;
+}
+
+bool Movie::Frame(Z80* z80, uint8_t buttons)
+{
+    if (file == NULL && !playing)
+    {
+        z80->GetJoypad()->SetButtons(buttons);
+        return true;
+    }
+
+    frame++;
+    return Step(z80, buttons);
+}
+
+void Movie::Close()
+{
+    if (file != NULL)
+    {
+        header.frames = frame;
+        fseek(file, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, file);
+        fclose(file);
+        file = NULL;
+    }
+    playing = false;
+    records.clear();
+}
+
+bool Movie::IsRecording()
+{
+    return file != NULL;
+}
+
+bool Movie::IsPlaying()
+{
+    return playing;
+}
+
+uint32_t Movie::GetFrame()
+{
+    return frame;
+}
+
+uint32_t Movie::GetLength()
+{
+    return header.frames;
+}
+
+int64_t Movie::GetDesyncFrame()
+{
+    return desyncFrame;
+}
+
+const char* Movie::GetError()
+{
+    return error;
+}
+
+bool Movie::Fail(const char* error)
+{
+    this->error = error;
+    return false;
+}
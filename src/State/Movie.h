@@ -0,0 +1,84 @@
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "State/SaveState.h"
+#include "Z80/Z80.h"
+
+/** @brief Records the joypad each frame so a run can be played back exactly
+ * A movie starts with the state it was recorded from, then has a record for every frame: the
+ * buttons held during it and Z80::HashState at the start of it. Input only changes
+ * between frames, so playing the buttons back from the same state repeats the run bit for bit.
+ * The hashes are checked while playing, so a desync is caught at the first frame it happens
+ * rather than when it shows on screen.
+ */
+class Movie
+{
+public:
+    Movie();
+    virtual ~Movie();
+
+    /** @brief Starts recording from z80's current state
+     *
+     * @return false if the file couldn't be created
+     *
+     */
+    bool Record(const char* path, Z80* z80);
+
+    /** @brief Loads the movie's state into z80 and starts playing
+     *
+     * @return false if the movie couldn't be read or is for another ROM, see GetError
+     *
+     */
+    bool Play(const char* path, Z80* z80);
+
+    /** @brief Call between frames. Records or plays back the buttons for the next frame.
+     * Once a movie has finished playing, the buttons passed in are used.
+     *
+     * @param z80 Z80*
+     * @param buttons uint8_t Held buttons (JoypadButton bits), used when recording
+     * @return false on the frame a desync is found
+     *
+     */
+    bool Frame(Z80* z80, uint8_t buttons);
+
+    void Close(); // Writes the final header when recording
+
+    bool IsRecording();
+    bool IsPlaying(); // False once the movie has finished
+    uint32_t GetFrame(); // Frames recorded or played so far
+    uint32_t GetLength(); // Frames in the movie being played
+    int64_t GetDesyncFrame(); // First frame whose state didn't match, -1 if none
+    const char* GetError();
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t romHash;
+        uint32_t frames; // There's a record for each and one for the state at the end
+        uint32_t stateSize; // Bytes of the starting state, which follows the header
+    };
+
+    // Each frame's record is the buttons then the state hash, 9 bytes with no padding
+    static const int RecordSize = 9;
+
+    Header header;
+    FILE* file; // While recording
+    bool playing;
+    uint32_t frame;
+    int64_t desyncFrame;
+    const char* error;
+
+    SaveState state; // The one the movie starts from
+    std::vector<uint8_t> records; // Of the movie being played
+
+    bool Step(Z80* z80, uint8_t buttons);
+    bool Fail(const char* error);
+};
+
+#endif // MOVIE_H
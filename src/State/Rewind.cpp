@@ -0,0 +1,237 @@
+#include "Rewind.h"
+
+#include <string.h>
+#include <algorithm>
+
+using namespace std;
+
+Rewind::Rewind(size_t bufferBytes, int interval) : ring(bufferBytes)
+{
+    this->interval = interval > 0 ? interval : 1;
+    Clear();
+}
+
+Rewind::~Rewind()
+{
+}
+
+void Rewind::Clear()
+{
+    framesSinceCapture = 0;
+    atLatest = false;
+    latest.clear();
+    entries.clear();
+    used = 0;
+}
+
+void Rewind::Capture(Z80* z80)
+{
+    if (++framesSinceCapture < interval && !latest.empty())
+    {
+        return;
+    }
+    framesSinceCapture = 0;
+    atLatest = false;
+
+    state.Save(z80);
+    const vector<uint8_t>& data = state.GetData();
+    if (!latest.empty())
+    {
+        if (latest.size() == data.size())
+        {
+            Push(Encode(latest, data));
+        }
+        else
+        {
+            // Can't happen within one version of the format, but the deltas would be useless
+            entries.clear();
+            used = 0;
+        }
+    }
+    latest = data;
+}
+
+bool Rewind::Step(Z80* z80)
+{
+    if (latest.empty())
+    {
+        return false;
+    }
+
+    if (atLatest)
+    {
+        if (entries.empty())
+        {
+            return false;
+        }
+        size_t size = entries.back().size;
+        Pop();
+        Decode(scratch.data(), size, latest);
+    }
+
+    state.SetData(latest);
+    state.Load(z80);
+    atLatest = true;
+    framesSinceCapture = 0;
+    return true;
+}
+
+int Rewind::GetSnapshots()
+{
+    return latest.empty() ? 0 : entries.size() + 1;
+}
+
+int Rewind::GetInterval()
+{
+    return interval;
+}
+
+size_t Rewind::GetUsed()
+{
+    return used;
+}
+
+static inline uint8_t* WriteCount(uint8_t* out, size_t count)
+{
+    while (count >= 0x80)
+    {
+        *out++ = (count & 0x7F) | 0x80;
+        count >>= 7;
+    }
+    *out++ = count;
+    return out;
+}
+
+static inline const uint8_t* ReadCount(const uint8_t* in, size_t& count)
+{
+    count = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        uint8_t byte = *in++;
+        count |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return in;
+        }
+    }
+}
+
+/** @brief Encodes from XOR to into scratch
+ * The delta is a list of pairs of runs: a count of bytes that are the same, then a count of
+ * bytes that differ followed by their XOR. Unchanged bytes are skipped 8 at a time.
+ *
+ * @return The size of the delta
+ *
+ */
+size_t Rewind::Encode(const vector<uint8_t>& from, const vector<uint8_t>& to)
+{
+    size_t size = to.size();
+    // Worst case is alternating single bytes, 3 bytes of delta for every 2
+    if (scratch.size() < size * 2 + 16)
+    {
+        scratch.resize(size * 2 + 16);
+    }
+
+    const uint8_t* a = from.data();
+    const uint8_t* b = to.data();
+    uint8_t* out = scratch.data();
+    size_t i = 0;
+
+    while (i < size)
+    {
+        size_t start = i;
+        while (i + 8 <= size)
+        {
+            uint64_t x;
+            uint64_t y;
+            memcpy(&x, a + i, 8);
+            memcpy(&y, b + i, 8);
+            if (x != y)
+            {
+                break;
+            }
+            i += 8;
+        }
+        while (i < size && a[i] == b[i])
+        {
+            i++;
+        }
+        out = WriteCount(out, i - start);
+
+        // A difference ends at the first 4 bytes in a row that are the same, shorter gaps are
+        // cheaper to carry along as zeros than to start a new pair for
+        start = i;
+        while (i < size && (a[i] != b[i] || (i + 4 <= size && memcmp(a + i, b + i, 4) != 0)))
+        {
+            i++;
+        }
+        out = WriteCount(out, i - start);
+        for (size_t j = start; j < i; j++)
+        {
+            *out++ = a[j] ^ b[j];
+        }
+    }
+
+    return out - scratch.data();
+}
+
+void Rewind::Decode(const uint8_t* delta, size_t size, vector<uint8_t>& target)
+{
+    const uint8_t* end = delta + size;
+    uint8_t* out = target.data();
+
+    while (delta < end)
+    {
+        size_t same;
+        size_t different;
+        delta = ReadCount(delta, same);
+        delta = ReadCount(delta, different);
+        out += same;
+        for (size_t j = 0; j < different; j++)
+        {
+            *out++ ^= *delta++;
+        }
+    }
+}
+
+/** @brief Adds the delta in scratch to the ring, dropping the oldest deltas to make room
+ *
+ * @param size size_t
+ * @return void
+ *
+ */
+void Rewind::Push(size_t size)
+{
+    if (size > ring.size())
+    {
+        // Too big to keep, and the older deltas can't be reached without it
+        entries.clear();
+        used = 0;
+        return;
+    }
+
+    while (ring.size() - used < size)
+    {
+        used -= entries.front().size;
+        entries.pop_front();
+    }
+
+    size_t offset = entries.empty() ? 0 : (entries.front().offset + used) % ring.size();
+    size_t first = min(size, ring.size() - offset);
+    memcpy(&ring[offset], scratch.data(), first);
+    memcpy(&ring[0], scratch.data() + first, size - first);
+
+    entries.push_back({ offset, size });
+    used += size;
+}
+
+void Rewind::Pop()
+{
+    Entry entry = entries.back();
+    entries.pop_back();
+    used -= entry.size;
+
+    size_t first = min(entry.size, ring.size() - entry.offset);
+    memcpy(scratch.data(), &ring[entry.offset], first);
+    memcpy(scratch.data() + first, &ring[0], entry.size - first);
+}
@@ -0,0 +1,72 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include "State/SaveState.h"
+#include "Z80/Z80.h"
+
+/** @brief Keeps the last few minutes of states in a fixed amount of memory, to step back through
+ * Only the newest state is kept whole. Every older one is stored as the XOR of it and the
+ * state after it, which is almost all zeros since little changes in a few frames, with the
+ * runs of zeros encoded as counts. Stepping back undoes the newest delta, so it costs the
+ * same however much history there is. When the ring is full the oldest deltas are dropped.
+ */
+class Rewind
+{
+public:
+    /** @brief Sets up the ring, which is allocated once here
+     *
+     * @param bufferBytes size_t Memory for the deltas
+     * @param interval int Frames between snapshots
+     *
+     */
+    Rewind(size_t bufferBytes, int interval);
+    virtual ~Rewind();
+
+    void Capture(Z80* z80); // Call once a frame, takes a snapshot every interval frames
+
+    /** @brief Goes back a snapshot
+     * The first step after running goes back to the newest snapshot, each one after that to
+     * the snapshot before.
+     *
+     * @return false if there's no history left
+     *
+     */
+    bool Step(Z80* z80);
+
+    void Clear();
+
+    int GetSnapshots(); // Including the newest
+    int GetInterval();
+    size_t GetUsed(); // Bytes of the ring in use
+
+private:
+    struct Entry
+    {
+        size_t offset; // In the ring
+        size_t size;
+    };
+
+    int interval;
+    int framesSinceCapture;
+    bool atLatest; // The newest snapshot was the last thing loaded
+
+    SaveState state;
+    std::vector<uint8_t> latest; // The newest snapshot, whole
+    std::vector<uint8_t> scratch; // A delta being encoded or decoded
+
+    std::vector<uint8_t> ring;
+    std::deque<Entry> entries; // Oldest first
+    size_t used;
+
+    size_t Encode(const std::vector<uint8_t>& from, const std::vector<uint8_t>& to);
+    void Decode(const uint8_t* delta, size_t size, std::vector<uint8_t>& target);
+
+    void Push(size_t size);
+    void Pop(); // Copies the newest delta into scratch and frees it
+};
+
+#endif // REWIND_H
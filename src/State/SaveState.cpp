@@ -0,0 +1,262 @@
+#include "SaveState.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "State/StateStream.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char Magic[4] = { 'W', 'G', 'B', 'S' };
+
+/** @brief Maps a whole file copy-on-write
+ * The mapping can be written, but the writes only go to this process's copy of the pages.
+ *
+ * @param path const string&
+ * @param size size_t& Set to the size of the file
+ * @return The mapping, which is unmapped with its last reference, or empty if the file couldn't be mapped
+ *
+ */
+static shared_ptr<uint8_t> MapPrivate(const string& path, size_t& size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE section = NULL;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        section = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    }
+    CloseHandle(file);
+    if (section == NULL)
+    {
+        return nullptr;
+    }
+
+    // The view keeps the file mapped after the handles are closed
+    void* view = MapViewOfFile(section, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(section);
+    if (view == NULL)
+    {
+        return nullptr;
+    }
+
+    size = fileSize.QuadPart;
+    return shared_ptr<uint8_t>((uint8_t*)view, [](uint8_t* view) { UnmapViewOfFile(view); });
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        view = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (view == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    size_t length = info.st_size;
+    size = length;
+    return shared_ptr<uint8_t>((uint8_t*)view, [length](uint8_t* view) { munmap(view, length); });
+#endif
+}
+
+SaveState::SaveState()
+{
+    mappingSize = 0;
+    error = "";
+}
+
+SaveState::~SaveState()
+{
+}
+
+void SaveState::Save(Z80* z80, bool mappable)
+{
+    Header header;
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.romHash = z80->GetMMU()->GetRomHash();
+
+    data.clear();
+    mapping.reset();
+    StateWriter state(data);
+    if (mappable)
+    {
+        state.SetAlignment(PageAlignment);
+    }
+    state.Write(header);
+    z80->SaveState(state);
+
+    if (mappable)
+    {
+        z80->Unshare();
+    }
+}
+
+bool SaveState::Load(Z80* z80)
+{
+    size_t size;
+    const uint8_t* bytes = GetBytes(size);
+    Header header;
+    if (size < sizeof(header))
+    {
+        error = "No state";
+        return false;
+    }
+
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+    {
+        error = "Not a WolfGB state";
+        return false;
+    }
+    if (header.version != Version)
+    {
+        error = "State is from another version of WolfGB";
+        return false;
+    }
+    if (header.romHash != z80->GetMMU()->GetRomHash())
+    {
+        error = "State is for another ROM";
+        return false;
+    }
+
+    StateReader state(bytes + sizeof(header), size - sizeof(header));
+    state.SetMapping(mapping);
+    if (!z80->LoadState(state))
+    {
+        error = "State is damaged";
+        return false;
+    }
+    return true;
+}
+
+bool SaveState::WriteFile(const string& path)
+{
+    // Truncating a file that's mapped would pull the pages out from under whatever loaded it
+    string temp = path + ".tmp";
+    FILE* file = fopen(temp.c_str(), "wb");
+    if (file == NULL)
+    {
+        error = "Couldn't create the file";
+        return false;
+    }
+
+    size_t size;
+    const uint8_t* bytes = GetBytes(size);
+    bool written = fwrite(bytes, 1, size, file) == size;
+    written &= fclose(file) == 0;
+    if (!written)
+    {
+        remove(temp.c_str());
+        error = "Couldn't write the file";
+        return false;
+    }
+
+    // Either way the old file stays as it was until the new one takes its place, so if it
+    // can't be replaced there's still a state to go back to
+#ifdef _WIN32
+    // rename won't replace a file on Windows
+    bool replaced = MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool replaced = rename(temp.c_str(), path.c_str()) == 0;
+#endif
+    if (!replaced)
+    {
+        remove(temp.c_str());
+        error = "Couldn't replace the file";
+        return false;
+    }
+    return true;
+}
+
+bool SaveState::ReadFile(const string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+    {
+        error = "Couldn't open the file";
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    mapping.reset();
+    data.resize(size > 0 ? size : 0);
+    bool read = fread(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    if (!read)
+    {
+        data.clear();
+        error = "Couldn't read the file";
+    }
+    return read;
+}
+
+bool SaveState::MapFile(const string& path)
+{
+    data.clear();
+    mapping = MapPrivate(path, mappingSize);
+    if (!mapping)
+    {
+        error = "Couldn't map the file";
+        return false;
+    }
+    return true;
+}
+
+const vector<uint8_t>& SaveState::GetData()
+{
+    return data;
+}
+
+void SaveState::SetData(const vector<uint8_t>& data)
+{
+    // Assigning reuses the buffer once it's big enough
+    this->data = data;
+    mapping.reset();
+}
+
+bool SaveState::IsEmpty()
+{
+    return data.empty() && !mapping;
+}
+
+const uint8_t* SaveState::GetBytes(size_t& size)
+{
+    if (mapping)
+    {
+        size = mappingSize;
+        return mapping.get();
+    }
+    size = data.size();
+    return data.data();
+}
+
+const char* SaveState::GetError()
+{
+    return error;
+}
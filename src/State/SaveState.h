@@ -0,0 +1,75 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Z80/Z80.h"
+
+/** @brief A snapshot of the whole machine, kept in memory and optionally saved to a file
+ * The format is a header (magic, format version and the hash of the ROM the state belongs to)
+ * followed by the sections written by Z80::SaveState. Everything is copied out in a few
+ * memcpys with no formatting, and the buffer is reused, so saving and loading each take a
+ * few microseconds and can be done every frame.
+ * Files can be mapped instead of read (copy-on-write, so the machine's writes never reach
+ * the file). Loading a mapped state points paged memory at the file rather than copying it,
+ * so it takes the same time however much RAM the cartridge has, and machines that load the
+ * same mapping share its pages until they write to them.
+ */
+class SaveState
+{
+public:
+    SaveState();
+    virtual ~SaveState();
+
+    static const uint32_t Version = 5; // Bump when a section changes layout
+    static const size_t PageAlignment = 4096; // Of paged memory in mappable states, the page size of the usual CPUs
+
+    /** @brief Saves z80's state into the buffer
+     *
+     * @param z80 Z80*
+     * @param mappable bool Whether to pad paged memory out to whole pages of the file, for
+     * states that will be written to a file and mapped. Others can leave it out to save space.
+     * The machine also stops using any state file it was loaded from, as Windows won't replace
+     * a file while it's mapped.
+     * @return void
+     *
+     */
+    void Save(Z80* z80, bool mappable = false);
+    bool Load(Z80* z80); // False if the state is for another ROM or version, see GetError
+
+    /** @brief Writes the state to a file
+     * It's written next to the file and then moved over it, so the old file is only replaced
+     * once the new one is complete. Elsewhere a machine still using the old file's mapping
+     * keeps its pages.
+     *
+     * @return false if the file couldn't be written, see GetError
+     *
+     */
+    bool WriteFile(const std::string& path);
+    bool ReadFile(const std::string& path); // Only reads the file, Load applies it
+    bool MapFile(const std::string& path); // Maps the file instead, Load applies it
+
+    const std::vector<uint8_t>& GetData(); // Empty when the state is mapped
+    void SetData(const std::vector<uint8_t>& data);
+    bool IsEmpty();
+    const char* GetError(); // Why the last Load or ReadFile failed
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t romHash;
+    };
+
+    std::vector<uint8_t> data;
+    std::shared_ptr<uint8_t> mapping; // Used instead of data once a file is mapped
+    size_t mappingSize;
+    const char* error;
+
+    const uint8_t* GetBytes(size_t& size); // The data or the mapping
+};
+
+#endif // SAVESTATE_H
@@ -0,0 +1,195 @@
+#include "StateStream.h"
+
+#include <string.h>
+
+StateWriter::StateWriter(std::vector<uint8_t>& buffer, bool hashing) : buffer(buffer)
+{
+    sectionStart = 0;
+    alignment = 1;
+    this->hashing = hashing;
+}
+
+StateWriter::~StateWriter()
+{
+}
+
+bool StateWriter::IsHashing()
+{
+    return hashing;
+}
+
+void StateWriter::SetAlignment(size_t alignment)
+{
+    this->alignment = alignment > 0 ? alignment : 1;
+}
+
+void StateWriter::BeginSection(uint32_t tag)
+{
+    uint32_t header[2] = { tag, 0 };
+    Write(header, sizeof(header));
+    sectionStart = buffer.size();
+}
+
+void StateWriter::EndSection()
+{
+    uint32_t size = buffer.size() - sectionStart;
+    memcpy(&buffer[sectionStart - sizeof(uint32_t)], &size, sizeof(size));
+}
+
+void StateWriter::Write(const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void StateWriter::Align()
+{
+    // Counting the padding's size, which goes first
+    size_t end = buffer.size() + sizeof(uint32_t);
+    uint32_t padding = (alignment - end % alignment) % alignment;
+    Write(padding);
+    buffer.resize(buffer.size() + padding);
+}
+
+StateReader::StateReader(const uint8_t* data, size_t size)
+{
+    this->data = data;
+    this->size = size;
+    position = 0;
+    sectionEnd = 0;
+    failed = false;
+}
+
+StateReader::~StateReader()
+{
+}
+
+bool StateReader::HasSection(uint32_t tag)
+{
+    size_t sectionSize;
+    return FindSection(tag, sectionSize) != NULL;
+}
+
+bool StateReader::OpenSection(uint32_t tag)
+{
+    size_t sectionSize;
+    const uint8_t* section = FindSection(tag, sectionSize);
+    if (section == NULL)
+    {
+        sectionEnd = position;
+        failed = true;
+        return false;
+    }
+
+    position = section - data;
+    sectionEnd = position + sectionSize;
+    return true;
+}
+
+void StateReader::CloseSection()
+{
+    if (position != sectionEnd)
+    {
+        failed = true;
+    }
+}
+
+void StateReader::Read(void* out, size_t count)
+{
+    if (count > sectionEnd - position)
+    {
+        memset(out, 0, count);
+        failed = true;
+        return;
+    }
+
+    memcpy(out, data + position, count);
+    position += count;
+}
+
+void StateReader::Skip(size_t count)
+{
+    if (count > sectionEnd - position)
+    {
+        position = sectionEnd;
+        failed = true;
+        return;
+    }
+    position += count;
+}
+
+void StateReader::SkipPadding()
+{
+    uint32_t padding;
+    Read(padding);
+    if (padding > sectionEnd - position)
+    {
+        position = sectionEnd;
+        failed = true;
+        return;
+    }
+    position += padding;
+}
+
+void StateReader::SetMapping(const std::shared_ptr<uint8_t>& mapping)
+{
+    this->mapping = mapping;
+}
+
+const std::shared_ptr<uint8_t>& StateReader::GetMapping()
+{
+    return mapping;
+}
+
+uint8_t* StateReader::ReadMapped(size_t count)
+{
+    if (!mapping)
+    {
+        return NULL;
+    }
+    if (count > sectionEnd - position)
+    {
+        failed = true;
+        return NULL;
+    }
+
+    // The mapping is writable, data is only const so that buffers can be read too
+    uint8_t* bytes = mapping.get() + (data + position - mapping.get());
+    position += count;
+    return bytes;
+}
+
+bool StateReader::Failed()
+{
+    return failed;
+}
+
+/** @brief Walks the section headers looking for a tag
+ *
+ * @param tag uint32_t
+ * @param sectionSize size_t& Set to the size of the section found
+ * @return The start of the section, or NULL if there isn't one or the data is cut short
+ *
+ */
+const uint8_t* StateReader::FindSection(uint32_t tag, size_t& sectionSize)
+{
+    size_t offset = 0;
+    while (size - offset >= 2 * sizeof(uint32_t))
+    {
+        uint32_t header[2];
+        memcpy(header, data + offset, sizeof(header));
+        offset += sizeof(header);
+
+        if (header[1] > size - offset)
+        {
+            return NULL;
+        }
+        if (header[0] == tag)
+        {
+            sectionSize = header[1];
+            return data + offset;
+        }
+        offset += header[1];
+    }
+    return NULL;
+}
@@ -0,0 +1,104 @@
+#ifndef STATESTREAM_H
+#define STATESTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+// Section tags are 4 characters, stored so they read as text in a hex dump
+constexpr uint32_t StateTag(const char (&name)[5])
+{
+    return (uint32_t)(uint8_t)name[0] | (uint32_t)(uint8_t)name[1] << 8 | (uint32_t)(uint8_t)name[2] << 16 | (uint32_t)(uint8_t)name[3] << 24;
+}
+
+/** @brief Appends tagged sections of raw state to a buffer
+ * Each section is its tag, its size in bytes and then whatever the device wrote, copied
+ * straight from memory. Clearing the buffer keeps its capacity, so once a state has been
+ * saved into it, saving again doesn't allocate.
+ * A writer for hashing takes the same sections, but paged memory writes a hash of each page
+ * instead of its bytes, so the buffer is small and only hashed once it's complete.
+ * Align pads to a multiple of the writer's alignment from the start of the buffer, which lets
+ * paged memory sit on whole pages of a file that's mapped rather than read.
+ */
+class StateWriter
+{
+public:
+    StateWriter(std::vector<uint8_t>& buffer, bool hashing = false);
+    virtual ~StateWriter();
+
+    bool IsHashing();
+    void SetAlignment(size_t alignment); // For Align, 1 (no padding) by default
+
+    void BeginSection(uint32_t tag);
+    void EndSection(); // Fills in the size of the section
+
+    void Write(const void* data, size_t size);
+    void Align(); // The size of the padding then zeros, so readers can skip it without knowing the alignment
+
+    template <typename T>
+    void Write(const T& value)
+    {
+        Write(&value, sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t>& buffer;
+    size_t sectionStart;
+    size_t alignment;
+    bool hashing;
+};
+
+/** @brief Reads sections written by StateWriter
+ * Sections can be opened in any order and ones that aren't asked for are skipped, so adding
+ * a section doesn't break anything reading the others. Reading past the end of a section
+ * zero fills and marks the reader as failed rather than reading into the next one.
+ * Reading a copy with Skip instead of Read checks a state's layout without loading it.
+ * When the data is a mapped file, paged memory can keep pointers into it instead of copying.
+ */
+class StateReader
+{
+public:
+    StateReader(const uint8_t* data, size_t size);
+    virtual ~StateReader();
+
+    bool HasSection(uint32_t tag);
+    bool OpenSection(uint32_t tag); // Following reads come from the section, if there isn't one false and they fail
+    void CloseSection(); // Fails if the section has bytes that weren't read, so it has another layout
+
+    void Read(void* data, size_t size);
+    void Skip(size_t size);
+    void SkipPadding(); // Written by StateWriter::Align
+
+    void SetMapping(const std::shared_ptr<uint8_t>& mapping); // The data lies inside mapping, see SaveState::MapFile
+    const std::shared_ptr<uint8_t>& GetMapping();
+
+    /** @brief Reads by pointing into the mapping rather than copying
+     * The bytes can be written, but the writes only affect this process, not the file.
+     *
+     * @param size size_t
+     * @return The bytes, or NULL if the data isn't mapped or the section is too short
+     *
+     */
+    uint8_t* ReadMapped(size_t size);
+
+    template <typename T>
+    void Read(T& value)
+    {
+        Read(&value, sizeof(T));
+    }
+
+    bool Failed(); // Whether anything read went past the end of its section
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    size_t sectionEnd;
+    bool failed;
+    std::shared_ptr<uint8_t> mapping;
+
+    const uint8_t* FindSection(uint32_t tag, size_t& sectionSize);
+};
+
+#endif // STATESTREAM_H
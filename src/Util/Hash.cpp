@@ -0,0 +1,277 @@
+#include "Hash.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define HASH_X86
+#include <immintrin.h>
+#endif
+
+Hash::AccumulateFunc Hash::accumulate = NULL;
+const char* Hash::name = "";
+
+static const uint64_t Prime32_1 = 0x9E3779B1U;
+static const uint64_t Prime32_2 = 0x85EBCA77U;
+static const uint64_t Prime32_3 = 0xC2B2AE3DU;
+static const uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+
+// Mixed into the data of each lane, the start of XXH3's default secret
+static const uint64_t Key[8] =
+{
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL,
+    0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL, 0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL,
+};
+
+static inline uint64_t Read64(const uint8_t* data)
+{
+    uint64_t value;
+    memcpy(&value, data, 8);
+    return value;
+}
+
+static inline uint64_t Rotl64(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline void AccumulateLane(uint64_t* acc, int lane, uint64_t data)
+{
+    uint64_t keyed = data ^ Key[lane];
+    acc[lane ^ 1] += data;
+    acc[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+}
+
+static inline void Scramble(uint64_t* acc)
+{
+    for (int lane = 0; lane < 8; lane++)
+    {
+        acc[lane] = (acc[lane] ^ (acc[lane] >> 47) ^ Key[lane]) * Prime32_1;
+    }
+}
+
+static void AccumulateScalar(uint64_t* acc, const uint8_t* data, size_t stripes)
+{
+    for (size_t stripe = 0; stripe < stripes; stripe++)
+    {
+        for (int lane = 0; lane < 8; lane++)
+        {
+            AccumulateLane(acc, lane, Read64(data + lane * 8));
+        }
+        data += 64;
+
+        if ((stripe + 1) % 16 == 0)
+        {
+            Scramble(acc);
+        }
+    }
+}
+
+#ifdef HASH_X86
+__attribute__((target("sse2")))
+static void AccumulateSSE2(uint64_t* acc, const uint8_t* data, size_t stripes)
+{
+    __m128i a[4];
+    __m128i key[4];
+    for (int i = 0; i < 4; i++)
+    {
+        a[i] = _mm_loadu_si128((const __m128i*)(acc + i * 2));
+        key[i] = _mm_loadu_si128((const __m128i*)(Key + i * 2));
+    }
+    const __m128i prime = _mm_set_epi32(0, (int)Prime32_1, 0, (int)Prime32_1);
+
+    for (size_t stripe = 0; stripe < stripes; stripe++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            __m128i d = _mm_loadu_si128((const __m128i*)(data + i * 16));
+            __m128i keyed = _mm_xor_si128(d, key[i]);
+            // pmuludq multiplies the low 32 bits of each 64 bit lane
+            __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+            __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, swapped));
+        }
+        data += 64;
+
+        if ((stripe + 1) % 16 == 0)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                __m128i x = _mm_xor_si128(_mm_xor_si128(a[i], _mm_srli_epi64(a[i], 47)), key[i]);
+                __m128i low = _mm_mul_epu32(x, prime);
+                __m128i high = _mm_mul_epu32(_mm_srli_epi64(x, 32), prime);
+                a[i] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+            }
+        }
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        _mm_storeu_si128((__m128i*)(acc + i * 2), a[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void AccumulateAVX2(uint64_t* acc, const uint8_t* data, size_t stripes)
+{
+    __m256i a[2];
+    __m256i key[2];
+    for (int i = 0; i < 2; i++)
+    {
+        a[i] = _mm256_loadu_si256((const __m256i*)(acc + i * 4));
+        key[i] = _mm256_loadu_si256((const __m256i*)(Key + i * 4));
+    }
+    const __m256i prime = _mm256_set1_epi64x(Prime32_1);
+
+    for (size_t stripe = 0; stripe < stripes; stripe++)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            __m256i d = _mm256_loadu_si256((const __m256i*)(data + i * 32));
+            __m256i keyed = _mm256_xor_si256(d, key[i]);
+            __m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+            // Swaps neighbouring lanes, which are always in the same 128 bit half
+            __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm256_add_epi64(a[i], _mm256_add_epi64(product, swapped));
+        }
+        data += 64;
+
+        if ((stripe + 1) % 16 == 0)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                __m256i x = _mm256_xor_si256(_mm256_xor_si256(a[i], _mm256_srli_epi64(a[i], 47)), key[i]);
+                __m256i low = _mm256_mul_epu32(x, prime);
+                __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), prime);
+                a[i] = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+            }
+        }
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        _mm256_storeu_si256((__m256i*)(acc + i * 4), a[i]);
+    }
+}
+#endif
+
+/** @brief Picks the fastest accumulate loop the CPU supports, the first time it's called
+ *
+ * @return void
+ *
+ */
+void Hash::Init()
+{
+    static bool initialised = []
+    {
+        accumulate = AccumulateScalar;
+        name = "scalar";
+
+#ifdef HASH_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            accumulate = AccumulateAVX2;
+            name = "AVX2";
+        }
+        else if (__builtin_cpu_supports("sse2"))
+        {
+            accumulate = AccumulateSSE2;
+            name = "SSE2";
+        }
+#endif
+        return true;
+    }();
+    (void)initialised;
+}
+
+/** @brief Switches every hash to the named version, so tests can check they all agree
+ *
+ * @param version const char* "scalar", "SSE2" or "AVX2"
+ * @return false if the CPU can't run it, leaving the version as it was
+ *
+ */
+bool Hash::UseVersion(const char* version)
+{
+    Init();
+
+    if (strcmp(version, "scalar") == 0)
+    {
+        accumulate = AccumulateScalar;
+        name = "scalar";
+        return true;
+    }
+#ifdef HASH_X86
+    if (strcmp(version, "SSE2") == 0 && __builtin_cpu_supports("sse2"))
+    {
+        accumulate = AccumulateSSE2;
+        name = "SSE2";
+        return true;
+    }
+    if (strcmp(version, "AVX2") == 0 && __builtin_cpu_supports("avx2"))
+    {
+        accumulate = AccumulateAVX2;
+        name = "AVX2";
+        return true;
+    }
+#endif
+    return false;
+}
+
+/** @brief Hashes a block of memory
+ * Whole 64 byte stripes go through the (vectorised) accumulate loop, anything left over is
+ * added a word at a time, then the 8 accumulators are merged and mixed down to 64 bits.
+ *
+ * @param data const void*
+ * @param length size_t Bytes
+ * @return uint64_t
+ *
+ */
+uint64_t Hash::Hash64(const void* data, size_t length)
+{
+    Init();
+
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t acc[Lanes] = { Prime32_3, Prime64_1, Prime64_2, Prime64_3, Prime64_4, Prime32_2, Prime64_5, Prime32_1 };
+
+    size_t stripes = length / StripeSize;
+    accumulate(acc, bytes, stripes);
+    bytes += stripes * StripeSize;
+    length -= stripes * StripeSize;
+
+    int lane = 0;
+    for (; length >= 8; length -= 8, bytes += 8)
+    {
+        AccumulateLane(acc, lane++, Read64(bytes));
+    }
+    if (length > 0)
+    {
+        uint64_t last = 0;
+        memcpy(&last, bytes, length);
+        AccumulateLane(acc, lane, last ^ length);
+    }
+
+    uint64_t hash = (stripes * StripeSize + lane * 8 + length) * Prime64_1;
+    for (int i = 0; i < Lanes; i++)
+    {
+        hash ^= Rotl64(acc[i] * Prime64_2, 31) * Prime64_1;
+        hash = Rotl64(hash, 27) * Prime64_1 + Prime64_4;
+    }
+
+    // Avalanche, so every input bit affects every output bit
+    hash ^= hash >> 33;
+    hash *= Prime64_2;
+    hash ^= hash >> 29;
+    hash *= Prime64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+const char* Hash::GetName()
+{
+    Init();
+    return name;
+}
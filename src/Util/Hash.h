@@ -0,0 +1,35 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Fast 64 bit non-cryptographic hash
+ * Built the same way as xxHash's XXH3: 8 lanes of 64 bit accumulators, each adding the
+ * product of the low and high halves of its data (xor a key) plus its neighbour's data.
+ * XXH64 itself needs 64 bit multiplies, which SSE2 and AVX2 don't have. The 32x32->64
+ * multiplies used here do exist, so the hashing loop has SSE2 and AVX2 versions.
+ * Every version gives the same hash, so hashes can be compared between machines.
+ */
+class Hash
+{
+public:
+    static uint64_t Hash64(const void* data, size_t length);
+
+    static const char* GetName(); // Name of the version in use
+    static bool UseVersion(const char* version); // Switches to a version by name for tests, false if the CPU can't run it
+
+private:
+    static const int Lanes = 8;
+    static const int StripeSize = Lanes * 8; // Bytes added to the accumulators at once
+    static const int StripesPerBlock = 16; // The accumulators are scrambled after each block
+
+    typedef void (*AccumulateFunc)(uint64_t* acc, const uint8_t* data, size_t stripes);
+
+    static AccumulateFunc accumulate;
+    static const char* name;
+
+    static void Init();
+};
+
+#endif // HASH_H
@@ -0,0 +1,121 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <stddef.h>
+#include <atomic>
+
+/** @brief Bounded lock free queue for one producer thread and one consumer thread
+ * Items are written and read in place, so large items (whole frames) are never copied
+ * in or out. Neither side ever blocks, they only get NULL back when the queue is full or
+ * empty and decide for themselves whether to wait.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+    RingBuffer(size_t capacity)
+    {
+        // One slot is always left empty to tell a full queue from an empty one
+        size = capacity + 1;
+        items = new T[size];
+        head = 0;
+        tail = 0;
+    }
+
+    virtual ~RingBuffer()
+    {
+        delete[] items;
+    }
+
+    // Producer: the slot to fill, or NULL if the queue is full
+    T* BeginWrite()
+    {
+        size_t next = Next(tail.load(std::memory_order_relaxed));
+        if (next == head.load(std::memory_order_acquire))
+        {
+            return NULL;
+        }
+        return &items[tail.load(std::memory_order_relaxed)];
+    }
+
+    // Producer: makes the slot from BeginWrite visible to the consumer
+    void EndWrite()
+    {
+        tail.store(Next(tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    // Consumer: the oldest item, or NULL if the queue is empty
+    T* BeginRead()
+    {
+        size_t current = head.load(std::memory_order_relaxed);
+        if (current == tail.load(std::memory_order_acquire))
+        {
+            return NULL;
+        }
+        return &items[current];
+    }
+
+    // Consumer: frees the slot from BeginRead for the producer
+    void EndRead()
+    {
+        head.store(Next(head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    // Producer: copies in as many items as there is room for, returns how many
+    size_t Write(const T* source, size_t count)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        size_t space = (h > t ? h - t : h + size - t) - 1;
+        count = count < space ? count : space;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            items[t] = source[i];
+            t = Next(t);
+        }
+        tail.store(t, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: copies out up to count items, returns how many
+    size_t Read(T* destination, size_t count)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t available = Count();
+        count = count < available ? count : available;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            destination[i] = items[h];
+            h = Next(h);
+        }
+        head.store(h, std::memory_order_release);
+        return count;
+    }
+
+    size_t Count()
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_acquire);
+        return t >= h ? t - h : t + size - h;
+    }
+
+private:
+    T* items;
+    size_t size;
+    std::atomic<size_t> head; // Next slot to read, only written by the consumer
+    char padding[64]; // Keeps head and tail on separate cache lines so the threads don't fight over them
+    std::atomic<size_t> tail; // Next slot to write, only written by the producer
+
+    size_t Next(size_t index)
+    {
+        return index + 1 == size ? 0 : index + 1;
+    }
+
+    // Not copyable, the threads using it hold pointers into it
+    RingBuffer(const RingBuffer&);
+    RingBuffer& operator=(const RingBuffer&);
+};
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,85 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threads)
+{
+    if (threads <= 0)
+    {
+        threads = max(1, (int)thread::hardware_concurrency() - 1);
+    }
+
+    pending = 0;
+    running = true;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.push_back(thread(&ThreadPool::WorkerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(jobMutex);
+        running = false;
+    }
+    jobSignal.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::Run(function<void()> job)
+{
+    {
+        lock_guard<mutex> lock(jobMutex);
+        jobs.push_back(move(job));
+        pending++;
+    }
+    jobSignal.notify_one();
+}
+
+void ThreadPool::Wait(int maxPending)
+{
+    unique_lock<mutex> lock(jobMutex);
+    doneSignal.wait(lock, [this, maxPending] { return pending <= maxPending; });
+}
+
+int ThreadPool::GetPending()
+{
+    lock_guard<mutex> lock(jobMutex);
+    return pending;
+}
+
+/** @brief Worker thread, runs jobs until the pool is destroyed and the queue is empty
+ *
+ * @return void
+ *
+ */
+void ThreadPool::WorkerLoop()
+{
+    unique_lock<mutex> lock(jobMutex);
+
+    while (true)
+    {
+        jobSignal.wait(lock, [this] { return !jobs.empty() || !running; });
+        if (jobs.empty())
+        {
+            return;
+        }
+
+        function<void()> job = move(jobs.front());
+        jobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        pending--;
+        doneSignal.notify_all();
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @brief A fixed set of worker threads that run queued jobs in the background
+ */
+class ThreadPool
+{
+public:
+    ThreadPool(int threads); // 0 = one per core, less one for the emulation thread
+    virtual ~ThreadPool(); // Finishes every queued job
+
+    void Run(std::function<void()> job);
+    void Wait(int maxPending = 0); // Waits until no more than maxPending jobs are queued or running
+    int GetPending(); // Jobs queued or running
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobMutex;
+    std::condition_variable jobSignal;
+    std::condition_variable doneSignal;
+    int pending;
+    bool running;
+
+    void WorkerLoop();
+};
+
+#endif // THREADPOOL_H
@@ -931,9 +931,7 @@ int Instructions::LDDrHLm_a()
 
 int Instructions::LDIHLmr_a()
 {
-    uint8_t* HLm = mmu->GetMemoryPtr(registers->hl);
-    LDrr(HLm, &registers->a);
-    registers->hl++;
+    mmu->WriteByte(registers->hl++, registers->a);
     return 0;
 }
 
@@ -2803,42 +2801,58 @@ int Instructions::CBSET7L()
 }
 int Instructions::CBSET0HLm()
 {
-    CBSETbr(0, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(0, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBSET1HLm()
 {
-    CBSETbr(1, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(1, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBSET2HLm()
 {
-    CBSETbr(2, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(2, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBSET3HLm()
 {
-    CBSETbr(3, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(3, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBSET4HLm()
 {
-    CBSETbr(4, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(4, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBSET5HLm()
 {
-    CBSETbr(5, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(5, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBSET6HLm()
 {
-    CBSETbr(6, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(6, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBSET7HLm()
 {
-    CBSETbr(7, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSETbr(7, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 
@@ -3124,42 +3138,58 @@ int Instructions::CBRES7L()
 }
 int Instructions::CBRES0HLm()
 {
-    CBRESbr(0, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(0, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBRES1HLm()
 {
-    CBRESbr(1, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(1, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBRES2HLm()
 {
-    CBRESbr(2, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(2, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBRES3HLm()
 {
-    CBRESbr(3, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(3, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBRES4HLm()
 {
-    CBRESbr(4, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(4, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBRES5HLm()
 {
-    CBRESbr(5, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(5, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBRES6HLm()
 {
-    CBRESbr(6, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(6, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 int Instructions::CBRES7HLm()
 {
-    CBRESbr(7, mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBRESbr(7, &value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 
@@ -3200,7 +3230,9 @@ int Instructions::CBSWAPL()
 }
 int Instructions::CBSWAPHLm()
 {
-    CBSWAPn(mmu->GetMemoryPtr(registers->hl));
+    uint8_t value = mmu->ReadByte(registers->hl);
+    CBSWAPn(&value);
+    mmu->WriteByte(registers->hl, value);
     return 0;
 }
 
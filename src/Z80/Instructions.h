@@ -992,7 +992,7 @@ private:
         // 0xE0
         &Instructions::LDHnr_a,
         &Instructions::POPHL,
-        &Instructions::LDIOCrn_a,
+        &Instructions::LDIOCnr_a,
         &Instructions::NOP,
         &Instructions::NOP,
         &Instructions::PUSHHL,
@@ -1010,7 +1010,7 @@ private:
         // 0xF0
         &Instructions::LDHrn_a,
         &Instructions::POPAF,
-        &Instructions::NOP,
+        &Instructions::LDIOCrn_a,
         &Instructions::DI,
         &Instructions::NOP,
         &Instructions::PUSHAF,
@@ -1,10 +1,13 @@
 #include "Z80.h"
+#include "Util/Hash.h"
 
 Z80::Z80()
 {
     registers = new Registers();
     gpu = new GPU();
-    mmu = new MMU(gpu);
+    apu = new APU();
+    joypad = new Joypad();
+    mmu = new MMU(gpu, apu, joypad);
     instructions = new Instructions(registers, mmu);
     Reset();
 }
@@ -13,6 +16,8 @@ Z80::~Z80()
 {
     delete instructions;
     delete mmu;
+    delete joypad;
+    delete apu;
     delete gpu;
     delete registers;
 }
@@ -24,6 +29,8 @@ void Z80::Reset()
 
     registers->Reset();
     gpu->Reset();
+    apu->Reset();
+    joypad->Reset();
     mmu->Reset();
 }
 
@@ -46,10 +53,117 @@ int Z80::Step()
     clock.t += cycles >> 2;
 
     gpu->Step(cycles);
+    apu->Step(cycles);
 
     return cycles;
 }
 
+void Z80::SaveState(StateWriter& state)
+{
+    state.BeginSection(StateTag("CPU "));
+    state.Write(registers->af);
+    state.Write(registers->bc);
+    state.Write(registers->de);
+    state.Write(registers->hl);
+    state.Write(registers->pc);
+    state.Write(registers->sp);
+    state.Write(clock);
+    state.EndSection();
+
+    mmu->SaveState(state);
+    gpu->SaveState(state);
+    apu->SaveState(state);
+    joypad->SaveState(state);
+}
+
+bool Z80::LoadState(StateReader& state)
+{
+    // Go through a copy of the reader first, so a state that's missing a section, is cut short
+    // or was saved with another layout is turned down before anything has been overwritten
+    StateReader check = state;
+    CheckState(check);
+    if (check.Failed())
+    {
+        return false;
+    }
+
+    state.OpenSection(StateTag("CPU "));
+    state.Read(registers->af);
+    state.Read(registers->bc);
+    state.Read(registers->de);
+    state.Read(registers->hl);
+    state.Read(registers->pc);
+    state.Read(registers->sp);
+    state.Read(clock);
+
+    mmu->LoadState(state);
+    gpu->LoadState(state);
+    apu->LoadState(state);
+    joypad->LoadState(state);
+    return !state.Failed();
+}
+
+/** @brief Skips through every section the way LoadState reads them
+ *
+ * @return void, state has failed if the sections don't match what LoadState expects
+ *
+ */
+void Z80::CheckState(StateReader& state)
+{
+    state.OpenSection(StateTag("CPU "));
+    state.Skip(sizeof(registers->af));
+    state.Skip(sizeof(registers->bc));
+    state.Skip(sizeof(registers->de));
+    state.Skip(sizeof(registers->hl));
+    state.Skip(sizeof(registers->pc));
+    state.Skip(sizeof(registers->sp));
+    state.Skip(sizeof(clock));
+    state.CloseSection();
+
+    mmu->CheckState(state);
+    gpu->CheckState(state);
+    apu->CheckState(state);
+    joypad->CheckState(state);
+}
+
+uint64_t Z80::HashState()
+{
+    hashBuffer.clear();
+    StateWriter state(hashBuffer, true);
+    SaveState(state);
+    return Hash::Hash64(hashBuffer.data(), hashBuffer.size());
+}
+
+void Z80::Fork(Z80* const* children, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        children[i]->ForkFrom(this);
+    }
+}
+
+void Z80::ForkFrom(Z80* parent)
+{
+    *registers = *parent->registers;
+    clock = parent->clock;
+
+    mmu->ForkFrom(*parent->mmu);
+    gpu->ForkFrom(*parent->gpu);
+    apu->ForkFrom(*parent->apu);
+    joypad->ForkFrom(*parent->joypad);
+}
+
+void Z80::Unshare()
+{
+    mmu->Unshare();
+    gpu->Unshare();
+}
+
+size_t Z80::GetPagesCopied()
+{
+    return mmu->GetPagesCopied() + gpu->GetPagesCopied();
+}
+
 Registers* Z80::GetRegisters()
 {
     return registers;
@@ -64,3 +178,13 @@ GPU* Z80::GetGPU()
 {
     return gpu;
 }
+
+APU* Z80::GetAPU()
+{
+    return apu;
+}
+
+Joypad* Z80::GetJoypad()
+{
+    return joypad;
+}
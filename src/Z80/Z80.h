@@ -2,10 +2,14 @@
 #define Z80_H
 
 #include <stdint.h>
+#include <vector>
 #include "Registers.h"
 #include "Instructions.h"
 #include "Memory/MMU.h"
 #include "GPU/GPU.h"
+#include "Audio/APU.h"
+#include "Input/Joypad.h"
+#include "State/StateStream.h"
 
 class Z80
 {
@@ -17,9 +21,41 @@ public:
     void Reset();
     int Step(); // Steps through CPU. Returns the amount of M clock cycles
 
+    void SaveState(StateWriter& state); // Writes a section for the CPU and each device
+    bool LoadState(StateReader& state); // False, with nothing changed, if a section is missing or doesn't fit
+
+    /** @brief Hashes everything a save state would hold
+     * RAM pages keep their hashes until they're written, so only the pages written since the
+     * last hash and the small state outside RAM are hashed again. Equal states give equal
+     * hashes whatever happened in between, including forking and loading states.
+     *
+     * @return uint64_t
+     *
+     */
+    uint64_t HashState();
+
+    /** @brief Makes each child carry on from where this machine is, for searching through inputs
+     * The children share this machine's ROM and RAM pages, and a page is only copied by
+     * whichever machine first writes to it, so forking costs the pages written rather than
+     * the size of memory. Children are reused rather than created, as setting up a machine's
+     * audio is far slower than forking. Once forked the children and this machine can run on
+     * separate threads, but nothing can be running while it's forked again.
+     *
+     * @param children Z80* const* Machines to overwrite
+     * @param count int
+     * @return void
+     *
+     */
+    void Fork(Z80* const* children, int count);
+    void ForkFrom(Z80* parent);
+    void Unshare(); // Copies the RAM pages shared with forks or a mapped state, see SaveState::Save
+    size_t GetPagesCopied(); // Copies made on write since this machine was created
+
     Registers* GetRegisters();
     MMU* GetMMU();
     GPU* GetGPU();
+    APU* GetAPU();
+    Joypad* GetJoypad();
 protected:
 private:
 
@@ -34,6 +70,12 @@ private:
     Instructions* instructions;
     MMU* mmu;
     GPU* gpu;
+    APU* apu;
+    Joypad* joypad;
+
+    std::vector<uint8_t> hashBuffer; // The state with page hashes in place of RAM, reused
+
+    void CheckState(StateReader& state);
 
     // Map of the number of m clock cycles by opcode
     uint8_t ClockCycles[0x100] =
@@ -1,99 +1,1094 @@
 #include <SDL.h>
 #include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Z80/Z80.h"
+#include "Audio/AudioOutput.h"
 #include "Debug/GDDB.h"
+#include "Display/Display.h"
+#include "Display/FramePacer.h"
+#include "Input/Joypad.h"
+#include "Capture/AudioRecorder.h"
+#include "Capture/Screenshots.h"
+#include "Capture/VideoRecorder.h"
+#include "State/Movie.h"
+#include "State/Rewind.h"
+#include "State/SaveState.h"
+#include "Util/Hash.h"
 
 using namespace std;
 
 
-SDL_Renderer* GetWindowRenderer();
+Display* OpenDisplay(bool threaded, int scale, ScaleFilter filter);
 
-SDL_Window* window = NULL;
-SDL_Renderer* windowRenderer = NULL;
+Display* display = NULL;
 
 Z80* z80;
 GDDB* gddb;
 
-const int SCREEN_WIDTH = 160;
-const int SCREEN_HEIGHT = 144;
-const int SCREEN_FPS = 60;
-const int SCREEN_TICKS_PER_FRAME = 1000 / SCREEN_FPS;
+bool SetPalette(GPU* gpu, string palette);
+bool ParseSpeed(string text, double& speed);
+bool ParseFloat(string text, float& value);
+bool ParseInt(string text, int& value, int minimum);
+bool GetJoypadButton(SDL_Keycode key, JoypadButton& button);
+void CaptureRequested(Screenshots* screenshots, const uint32_t* pixels);
+void RunFrame(Z80* z80);
 
 int main(int argc, char *argv[])
 {
+    string romPath = "F:\\Users\\Saintwolf\\Documents\\Programming\\Gameboy\\cpu_instrs.gb";
+    string palette = "grey";
+    float gamma = 1.0f;
+    RenderMode renderMode = RenderMode::Scanline;
+    bool headless = false;
+    bool threadedDisplay = true;
+    bool audio = true;
+    bool audioSync = false;
+    int audioLatency = 60; // Milliseconds, with audio sync
+    string audioQuality; // Empty = high, or linear when headless
+    uint32_t maxFrames = 0;
+    FrameSkip frameSkip = FrameSkip::Off;
+    int skipFrames = 0;
+    double speed = 1.0;
+    int scale = 0; // 0 = the filter's own factor
+    ScaleFilter filter = ScaleFilter::None;
+    string recordPath;
+    bool recordDropDuplicates = false;
+    string frameHashPath;
+    string stateHashPath;
+    uint32_t hashInterval = 1;
+    string dumpAudioPath;
+    string audioHashPath;
+    ImageFormat screenshotFormat = ImageFormat::PNG;
+    uint32_t screenshotInterval = 0;
+    int rewindMegabytes = 32; // 0 = no rewind
+    int rewindInterval = 2;
+    int runAhead = 0; // Frames
+    string recordMoviePath;
+    string playMoviePath;
+    string loadStatePath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--palette" && i + 1 < argc)
+        {
+            palette = argv[++i];
+        }
+        else if (arg == "--gamma" && i + 1 < argc)
+        {
+            if (!ParseFloat(argv[++i], gamma) || gamma <= 0.0f)
+            {
+                cout << "Invalid gamma: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--render" && i + 1 < argc)
+        {
+            string mode = argv[++i];
+            if (mode == "scanline")
+                renderMode = RenderMode::Scanline;
+            else if (mode == "deferred")
+                renderMode = RenderMode::Deferred;
+            else if (mode == "pipelined")
+                renderMode = RenderMode::Pipelined;
+            else
+            {
+                cout << "Invalid render mode: " << mode << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--headless")
+        {
+            headless = true;
+        }
+        else if (arg == "--no-audio")
+        {
+            audio = false;
+        }
+        else if (arg == "--sync" && i + 1 < argc)
+        {
+            string mode = argv[++i];
+            if (mode != "timer" && mode != "audio")
+            {
+                cout << "Invalid sync mode: " << mode << endl;
+                return 1;
+            }
+            audioSync = mode == "audio";
+        }
+        else if (arg == "--audio-latency" && i + 1 < argc)
+        {
+            if (!ParseInt(argv[++i], audioLatency, 10))
+            {
+                cout << "Invalid audio latency: " << argv[i] << " (at least 10ms)" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--audio-quality" && i + 1 < argc)
+        {
+            audioQuality = argv[++i];
+            if (audioQuality != "linear" && audioQuality != "low" && audioQuality != "medium" && audioQuality != "high")
+            {
+                cout << "Invalid audio quality: " << audioQuality << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--single-thread")
+        {
+            threadedDisplay = false;
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            int frames;
+            if (!ParseInt(argv[++i], frames, 0))
+            {
+                cout << "Invalid frame count: " << argv[i] << endl;
+                return 1;
+            }
+            maxFrames = frames;
+        }
+        else if (arg == "--frameskip" && i + 1 < argc)
+        {
+            // A fixed number of frames to skip between drawn frames, or auto to skip when running behind
+            string skip = argv[++i];
+            if (skip == "auto")
+            {
+                frameSkip = FrameSkip::Auto;
+                skipFrames = 4;
+            }
+            else
+            {
+                if (!ParseInt(skip, skipFrames, 0))
+                {
+                    cout << "Invalid frame skip: " << skip << endl;
+                    return 1;
+                }
+                frameSkip = skipFrames > 0 ? FrameSkip::Fixed : FrameSkip::Off;
+            }
+        }
+        else if (arg == "--speed" && i + 1 < argc)
+        {
+            if (!ParseSpeed(argv[++i], speed))
+            {
+                cout << "Invalid speed: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--scale" && i + 1 < argc)
+        {
+            // The range is checked against the filter once both are known
+            if (!ParseInt(argv[++i], scale, 1))
+            {
+                cout << "Invalid scale: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            if (name == "none")
+                filter = ScaleFilter::None;
+            else if (name == "scale2x")
+                filter = ScaleFilter::Scale2x;
+            else if (name == "scale3x")
+                filter = ScaleFilter::Scale3x;
+            else
+            {
+                cout << "Invalid filter: " << name << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--record-dedup")
+        {
+            recordDropDuplicates = true;
+        }
+        else if (arg == "--frame-hashes" && i + 1 < argc)
+        {
+            frameHashPath = argv[++i];
+        }
+        else if (arg == "--state-hashes" && i + 1 < argc)
+        {
+            stateHashPath = argv[++i];
+        }
+        else if (arg == "--hash-interval" && i + 1 < argc)
+        {
+            int interval;
+            if (!ParseInt(argv[++i], interval, 1))
+            {
+                cout << "Invalid hash interval: " << argv[i] << endl;
+                return 1;
+            }
+            hashInterval = interval;
+        }
+        else if (arg == "--dump-audio" && i + 1 < argc)
+        {
+            dumpAudioPath = argv[++i];
+        }
+        else if (arg == "--audio-hashes" && i + 1 < argc)
+        {
+            audioHashPath = argv[++i];
+        }
+        else if (arg == "--screenshot-format" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            if (name == "png")
+                screenshotFormat = ImageFormat::PNG;
+            else if (name == "qoi")
+                screenshotFormat = ImageFormat::QOI;
+            else
+            {
+                cout << "Invalid screenshot format: " << name << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--screenshots" && i + 1 < argc)
+        {
+            // Saves every nth frame
+            int interval;
+            if (!ParseInt(argv[++i], interval, 0))
+            {
+                cout << "Invalid screenshot interval: " << argv[i] << endl;
+                return 1;
+            }
+            screenshotInterval = interval;
+        }
+        else if (arg == "--rewind-buffer" && i + 1 < argc)
+        {
+            if (!ParseInt(argv[++i], rewindMegabytes, 0))
+            {
+                cout << "Invalid rewind buffer size: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--rewind-interval" && i + 1 < argc)
+        {
+            if (!ParseInt(argv[++i], rewindInterval, 1))
+            {
+                cout << "Invalid rewind interval: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--runahead" && i + 1 < argc)
+        {
+            if (!ParseInt(argv[++i], runAhead, 0))
+            {
+                cout << "Invalid run-ahead frames: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--record-movie" && i + 1 < argc)
+        {
+            recordMoviePath = argv[++i];
+        }
+        else if (arg == "--play-movie" && i + 1 < argc)
+        {
+            playMoviePath = argv[++i];
+        }
+        else if (arg == "--load-state" && i + 1 < argc)
+        {
+            loadStatePath = argv[++i];
+        }
+        else if (arg[0] != '-')
+        {
+            romPath = arg;
+        }
+        else
+        {
+            cout << "Usage: WolfGB [rom] [--palette grey|green|RRGGBB,RRGGBB,RRGGBB,RRGGBB] [--gamma n]"
+                 << " [--render scanline|deferred|pipelined] [--headless] [--no-audio] [--sync timer|audio] [--audio-latency ms]"
+                 << " [--audio-quality linear|low|medium|high] [--single-thread] [--frames n]"
+                 << " [--frameskip n|auto] [--speed n|uncapped] [--scale n] [--filter none|scale2x|scale3x]"
+                 << " [--record out.y4m|out.rgb] [--record-dedup] [--frame-hashes out.txt] [--state-hashes out.txt] [--hash-interval n]"
+                 << " [--dump-audio out.wav] [--audio-hashes out.txt]"
+                 << " [--screenshot-format png|qoi] [--screenshots n]"
+                 << " [--rewind-buffer MB] [--rewind-interval n] [--runahead n]"
+                 << " [--record-movie out.wgbm] [--play-movie in.wgbm] [--load-state in.state]" << endl;
+            return 1;
+        }
+    }
 
     cout << "==================" << endl;
     cout << "Welcome to WolfGB!" << endl;
     cout << "==================" << endl << endl;
 
+    // The frame shown is run ahead and then thrown away, so it has to be drawn before the state is put back
+    if (runAhead > 0 && renderMode == RenderMode::Pipelined)
+    {
+        cout << "Run-ahead needs frames drawn straight away, using deferred rendering" << endl;
+        renderMode = RenderMode::Deferred;
+    }
+
 
-    cout << "Initialising LCD" << endl;
-    windowRenderer = GetWindowRenderer();
+    if (!headless)
+    {
+        cout << "Initialising LCD" << endl;
+        display = OpenDisplay(threadedDisplay, scale, filter);
+        if (display == NULL)
+        {
+            return 1;
+        }
+    }
 
     cout << "Initialising GB Hardware" << endl;
     z80 = new Z80();
-    z80->GetGPU()->SetRenderer(windowRenderer);
+
+    // Nothing is listening when headless, so the cheapest resampler will do
+    if (audioQuality.empty())
+        audioQuality = headless ? "linear" : "high";
+    if (audioQuality == "linear")
+        z80->GetAPU()->SetResamplerQuality(ResamplerQuality::Linear);
+    else if (audioQuality == "low")
+        z80->GetAPU()->SetResamplerQuality(ResamplerQuality::Low);
+    else if (audioQuality == "medium")
+        z80->GetAPU()->SetResamplerQuality(ResamplerQuality::Medium);
+    else if (audioQuality == "high")
+        z80->GetAPU()->SetResamplerQuality(ResamplerQuality::High);
+
+    AudioOutput* audioOutput = NULL;
+    if (!headless && audio)
+    {
+        cout << "Initialising Audio" << endl;
+        audioOutput = new AudioOutput();
+        // Audio sync keeps the queue short, so SDL needs to ask for samples more often
+        if (audioOutput->Open(48000, audioSync ? 512 : 1024))
+        {
+            z80->GetAPU()->SetSampleRate(audioOutput->GetSampleRate());
+            if (audioSync)
+            {
+                audioOutput->SetLatency(audioOutput->GetSampleRate() * audioLatency / 1000);
+            }
+        }
+        else
+        {
+            delete audioOutput;
+            audioOutput = NULL;
+        }
+    }
+    if (!SetPalette(z80->GetGPU(), palette))
+    {
+        cout << "Invalid palette: " << palette << endl;
+        return 1;
+    }
+    z80->GetGPU()->SetGamma(gamma);
+    z80->GetGPU()->SetRenderMode(renderMode);
     cout << "Loading ROM" << endl;
-    z80->GetMMU()->LoadRom("F:\\Users\\Saintwolf\\Documents\\Programming\\Gameboy\\cpu_instrs.gb");
+    z80->GetMMU()->LoadRom(romPath);
     z80->Reset();
 
+    Screenshots* screenshots = new Screenshots(screenshotFormat);
+
+    // States are saved next to the ROM, as name.state
+    size_t extension = romPath.find_last_of('.');
+    size_t folder = romPath.find_last_of("/\\");
+    string statePath = (extension != string::npos && (folder == string::npos || extension > folder) ? romPath.substr(0, extension) : romPath) + ".state";
+    SaveState quickState;
+
+    // Starts from a state file instead of booting, mapped so its RAM is only copied once it's written
+    if (!loadStatePath.empty())
+    {
+        auto loadStart = chrono::steady_clock::now();
+        if (!quickState.MapFile(loadStatePath) || !quickState.Load(z80))
+        {
+            cout << "Couldn't load state " << loadStatePath << ": " << quickState.GetError() << endl;
+            return 1;
+        }
+        double loadMicros = chrono::duration<double, micro>(chrono::steady_clock::now() - loadStart).count();
+        cout << "Loaded state from " << loadStatePath << " (" << loadMicros << "us)" << endl;
+    }
+
     cout << "Initialising GDDB" << endl;
     gddb = new GDDB(z80);
+    gddb->SetScreenshots(screenshots);
+    gddb->SetStatePath(statePath);
+    if (headless)
+    {
+        gddb->enabled = false;
+    }
 
-    bool running = true;
+    atomic<bool> running(true); // Cleared by the emulation thread when it stops
 
     const int CPUCLOCK_FRAME_TICKS = 70224;
     int cpuClock = 0;
 
-    int startTime = SDL_GetTicks();
+    VideoRecorder* recorder = NULL;
+    if (!recordPath.empty())
+    {
+        recorder = new VideoRecorder();
+        if (!recorder->Open(recordPath.c_str(), recordDropDuplicates))
+        {
+            return 1;
+        }
+    }
+
+    // One line per hashed frame: frame number and hash
+    FILE* frameHashes = NULL;
+    if (!frameHashPath.empty())
+    {
+        frameHashes = fopen(frameHashPath.c_str(), "w");
+        if (frameHashes == NULL)
+        {
+            cout << "Couldn't create " << frameHashPath << endl;
+            return 1;
+        }
+    }
+
+    // The same for the whole machine state, which catches a desync before it shows on screen
+    FILE* stateHashes = NULL;
+    double stateHashSeconds = 0.0;
+    uint32_t stateHashCount = 0;
+    if (!stateHashPath.empty())
+    {
+        stateHashes = fopen(stateHashPath.c_str(), "w");
+        if (stateHashes == NULL)
+        {
+            cout << "Couldn't create " << stateHashPath << endl;
+            return 1;
+        }
+    }
 
-    SDL_Event e;
+    GPU* gpu = z80->GetGPU();
+    APU* apu = z80->GetAPU();
 
-    while (running)
+    AudioRecorder* audioRecorder = NULL;
+    if (!dumpAudioPath.empty())
     {
-        while (SDL_PollEvent(&e) != 0)
+        audioRecorder = new AudioRecorder();
+        if (!audioRecorder->Open(dumpAudioPath.c_str(), apu->GetSampleRate()))
         {
-            // User requests quit
-            if (e.type == SDL_QUIT)
+            return 1;
+        }
+    }
+
+    // Same format as the frame hashes, each hash covering the samples since the last one.
+    // Taken from the synthesis output, so the host's sample rate and resampler don't change it.
+    FILE* audioHashes = NULL;
+    vector<StereoSample> hashSamples;
+    if (!audioHashPath.empty())
+    {
+        audioHashes = fopen(audioHashPath.c_str(), "w");
+        if (audioHashes == NULL)
+        {
+            cout << "Couldn't create " << audioHashPath << endl;
+            return 1;
+        }
+        apu->SetSynthesisTap(&hashSamples);
+    }
+
+    // Headless or with --no-audio, skip synthesis unless the samples are being kept
+    bool silent = audioOutput == NULL && audioRecorder == NULL && audioHashes == NULL;
+    apu->SetSilent(silent);
+
+    StereoSample samples[4096];
+    uint32_t lastFrame = gpu->GetFrameCount();
+    uint32_t framesRun = 0;
+
+    FramePacer pacer;
+    pacer.SetFrameSkip(frameSkip, skipFrames);
+    pacer.SetSpeed(speed);
+    bool turbo = false; // Tab held for uncapped speed
+
+    // While a movie is recording or playing it has the joypad, and keys are only passed on between frames
+    Movie* movie = NULL;
+    uint8_t heldButtons = 0;
+    if (!playMoviePath.empty() || !recordMoviePath.empty())
+    {
+        movie = new Movie();
+        bool play = !playMoviePath.empty();
+        if (play ? !movie->Play(playMoviePath.c_str(), z80) : !movie->Record(recordMoviePath.c_str(), z80))
+        {
+            cout << "Couldn't " << (play ? "play" : "record") << " movie: " << movie->GetError() << endl;
+            return 1;
+        }
+        if (play)
+        {
+            cout << "Playing " << playMoviePath << ", " << movie->GetLength() << " frames" << endl;
+            lastFrame = gpu->GetFrameCount();
+        }
+    }
+
+    // Only worth the memory when there's someone to hold the key. Going back would break a movie.
+    Rewind* rewind = NULL;
+    bool rewinding = false; // Backspace held
+    if (display != NULL && rewindMegabytes > 0 && movie == NULL)
+    {
+        rewind = new Rewind((size_t)rewindMegabytes * 1024 * 1024, rewindInterval);
+    }
+
+    SaveState aheadState; // Reused every frame, so run-ahead doesn't allocate once it's going
+    double aheadSeconds = 0.0;
+    uint32_t aheadFrames = 0;
+    auto runStart = chrono::steady_clock::now();
+
+    // With a threaded display, this thread keeps the window and presents while emulation runs
+    // on another, so emulation never waits for the display
+    auto emulate = [&]()
+    {
+        SDL_Event e;
+        JoypadButton button;
+
+        while (running)
+        {
+            gddb->Step();
+            cpuClock += z80->Step();
+
+            // Hand each drawn frame to the display, and keep to the frame rate
+            if (gpu->GetFrameCount() != lastFrame)
             {
-                running = false;
+                lastFrame = gpu->GetFrameCount();
+                if (gpu->IsFrameDrawn())
+                {
+                    // With run-ahead, the frame shown is one further on. Frames only drawn for the
+                    // recorder, hashes or screenshots aren't shown, so frame skip still applies.
+                    if (gpu->IsFrameShown() && (runAhead == 0 || rewinding))
+                    {
+                        if (display != NULL)
+                        {
+                            display->PushFrame(gpu->GetFrameBuffer());
+                        }
+                        CaptureRequested(screenshots, gpu->GetFrameBuffer());
+                    }
+                    if (recorder != NULL)
+                    {
+                        recorder->PushFrame(gpu->GetFrameBuffer());
+                    }
+                    // Pipelined frames come out a frame late, so they're numbered by the frame drawn
+                    uint32_t drawnFrame = gpu->GetDrawnFrame();
+                    if (frameHashes != NULL && drawnFrame % hashInterval == 0)
+                    {
+                        fprintf(frameHashes, "%u %016" PRIx64 "\n", drawnFrame, gpu->GetFrameHash());
+                    }
+                    if (screenshotInterval != 0 && drawnFrame % screenshotInterval == 0)
+                    {
+                        screenshots->Capture(gpu->GetFrameBuffer());
+                    }
+                }
+
+                if (stateHashes != NULL && lastFrame % hashInterval == 0)
+                {
+                    auto hashStart = chrono::steady_clock::now();
+                    uint64_t hash = z80->HashState();
+                    stateHashSeconds += chrono::duration<double>(chrono::steady_clock::now() - hashStart).count();
+                    stateHashCount++;
+                    fprintf(stateHashes, "%u %016" PRIx64 "\n", lastFrame, hash);
+                }
+
+                bool realTime = speed == 1.0 && !turbo;
+                bool audioPaced = audioOutput != NULL && audioSync && realTime;
+                if (audioOutput != NULL || audioRecorder != NULL || audioHashes != NULL)
+                {
+                    int count = apu->ReadSamples(samples, 4096);
+
+                    if (audioRecorder != NULL)
+                    {
+                        audioRecorder->PushSamples(samples, count);
+                    }
+                    if (audioHashes != NULL)
+                    {
+                        if (lastFrame % hashInterval == 0)
+                        {
+                            uint64_t hash = Hash::Hash64(hashSamples.data(), hashSamples.size() * sizeof(StereoSample));
+                            fprintf(audioHashes, "%u %016" PRIx64 "\n", lastFrame, hash);
+                            hashSamples.clear();
+                        }
+                    }
+
+                    if (audioOutput != NULL)
+                    {
+                        // With audio sync, waiting for room in the queue is what paces emulation, so
+                        // it runs at exactly the sound card's rate. Otherwise the frame pacer keeps
+                        // time and the sample rate is steered to keep the queue half full, so the
+                        // two clocks drifting apart doesn't drop samples or run the queue dry.
+                        audioOutput->Write(samples, count, audioPaced);
+                        apu->SetRateAdjustment(realTime && !audioPaced ? audioOutput->GetRateAdjustment() : 1.0);
+                    }
+                }
+                pacer.SetWaiting(!audioPaced);
+
+                // Frames that are recorded, hashed or saved as screenshots are always drawn, only presenting is paced
+                // A requested screenshot is of the next frame shown, even if it would have been skipped
+                bool draw = pacer.EndFrame() || screenshots->IsRequested();
+                uint32_t nextFrame = lastFrame + 1;
+                bool keepFrames = recorder != NULL || (frameHashes != NULL && nextFrame % hashInterval == 0) ||
+                                  (screenshotInterval != 0 && nextFrame % screenshotInterval == 0);
+                gpu->SetDrawNextFrame(draw || keepFrames, draw);
+
+                if (movie != NULL)
+                {
+                    bool wasPlaying = movie->IsPlaying();
+                    if (!movie->Frame(z80, heldButtons))
+                    {
+                        cout << "Movie desynced at frame " << movie->GetDesyncFrame() << endl;
+                    }
+                    if (wasPlaying && !movie->IsPlaying())
+                    {
+                        cout << "Movie finished" << endl;
+                        // Without a window there's nothing to take over the joypad
+                        if (display == NULL)
+                        {
+                            running = false;
+                        }
+                    }
+                }
+
+                // While rewinding, each frame shown is run from the snapshot before the last one
+                if (rewind != NULL)
+                {
+                    if (!rewinding)
+                    {
+                        rewind->Capture(z80);
+                    }
+                    else if (rewind->Step(z80))
+                    {
+                        lastFrame = gpu->GetFrameCount();
+                    }
+                }
+
+                // Run-ahead hides the frames of lag games have between reading the joypad and showing
+                // the result: run on with the current input, show the last frame, and go back
+                if (runAhead > 0 && !rewinding)
+                {
+                    auto aheadStart = chrono::steady_clock::now();
+                    aheadState.Save(z80);
+                    apu->SetSilent(true);
+                    for (int i = 0; i < runAhead; i++)
+                    {
+                        gpu->SetDrawNextFrame(draw && i == runAhead - 1);
+                        RunFrame(z80);
+                    }
+                    if (gpu->IsFrameDrawn())
+                    {
+                        if (display != NULL)
+                        {
+                            display->PushFrame(gpu->GetFrameBuffer());
+                        }
+                        CaptureRequested(screenshots, gpu->GetFrameBuffer());
+                    }
+                    aheadState.Load(z80);
+                    apu->SetSilent(silent);
+                    gpu->SetDrawNextFrame(keepFrames, false);
+
+                    aheadSeconds += chrono::duration<double>(chrono::steady_clock::now() - aheadStart).count();
+                    aheadFrames++;
+                }
+
+                // Show the speed actually achieved about twice a second
+                if (display != NULL && framesRun % 30 == 0)
+                {
+                    char title[64];
+                    snprintf(title, sizeof(title), "WolfGB - %.2fx", pacer.GetSpeed());
+                    display->SetTitle(title);
+                }
+
+                framesRun++;
+                if (maxFrames != 0 && framesRun >= maxFrames)
+                {
+                    running = false;
+                }
             }
+
+            if (cpuClock > CPUCLOCK_FRAME_TICKS)
+            {
+                cpuClock = 0;
+
+                while (display != NULL && display->PollEvent(e))
+                {
+                    // User requests quit
+                    if (e.type == SDL_QUIT)
+                    {
+                        running = false;
+                    }
+                    // 1-4 select 1x, 2x, 4x and uncapped speed, Tab runs uncapped while held
+                    else if (e.type == SDL_KEYDOWN && e.key.keysym.sym >= SDLK_1 && e.key.keysym.sym <= SDLK_4)
+                    {
+                        const double speeds[] = { 1.0, 2.0, 4.0, 0.0 };
+                        speed = speeds[e.key.keysym.sym - SDLK_1];
+                        pacer.SetSpeed(turbo ? 0.0 : speed);
+                        cout << "Speed: " << (speed > 0.0 ? to_string((int)speed) + "x" : "uncapped") << endl;
+                    }
+                    else if ((e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) && e.key.keysym.sym == SDLK_TAB && !e.key.repeat)
+                    {
+                        turbo = e.type == SDL_KEYDOWN;
+                        pacer.SetSpeed(turbo ? 0.0 : speed);
+                    }
+                    else if ((e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) && e.key.keysym.sym == SDLK_BACKSPACE && !e.key.repeat)
+                    {
+                        rewinding = e.type == SDL_KEYDOWN && rewind != NULL;
+                    }
+                    else if ((e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) && !e.key.repeat && GetJoypadButton(e.key.keysym.sym, button))
+                    {
+                        if (movie != NULL)
+                        {
+                            heldButtons = e.type == SDL_KEYDOWN ? heldButtons | (uint8_t)button : heldButtons & ~(uint8_t)button;
+                        }
+                        else
+                        {
+                            z80->GetJoypad()->SetButton(button, e.type == SDL_KEYDOWN);
+                        }
+                    }
+                    else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F12 && !e.key.repeat)
+                    {
+                        screenshots->Request();
+                    }
+                    // F5 saves the state and F9 loads it back
+                    else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F5 && !e.key.repeat)
+                    {
+                        quickState.Save(z80, true);
+                        if (quickState.WriteFile(statePath))
+                            cout << "Saved state to " << statePath << endl;
+                        else
+                            cout << "Couldn't save state: " << quickState.GetError() << endl;
+                    }
+                    else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F9 && !e.key.repeat)
+                    {
+                        if (movie != NULL && (movie->IsRecording() || movie->IsPlaying()))
+                        {
+                            cout << "Can't load a state during a movie" << endl;
+                        }
+                        else if (quickState.MapFile(statePath) && quickState.Load(z80))
+                        {
+                            cout << "Loaded state from " << statePath << endl;
+                            lastFrame = gpu->GetFrameCount();
+                        }
+                        else
+                        {
+                            cout << "Couldn't load state: " << quickState.GetError() << endl;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    if (display != NULL && display->IsThreaded())
+    {
+        thread emulation(emulate);
+        display->Run(running);
+        emulation.join();
+    }
+    else
+    {
+        emulate();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+    cout << "Ran " << framesRun << " frames in " << seconds << "s ("
+         << framesRun / seconds / FramePacer::FramesPerSecond << "x)" << endl;
+
+    if (frameHashes != NULL)
+    {
+        fclose(frameHashes);
+    }
+    if (stateHashes != NULL)
+    {
+        fclose(stateHashes);
+        if (stateHashCount > 0)
+        {
+            cout << "Hashing the state took " << stateHashSeconds / stateHashCount * 1000000.0 << "us per frame" << endl;
+        }
+    }
+    if (audioHashes != NULL)
+    {
+        fclose(audioHashes);
+    }
+
+    if (movie != NULL)
+    {
+        if (movie->IsRecording())
+        {
+            cout << "Recorded " << movie->GetFrame() << " frames of input" << endl;
         }
+        else
+        {
+            cout << "Played " << movie->GetFrame() << " of " << movie->GetLength() << " movie frames, ";
+            if (movie->GetDesyncFrame() >= 0)
+                cout << "desynced at frame " << movie->GetDesyncFrame() << endl;
+            else
+                cout << "in sync" << endl;
+        }
+        movie->Close();
+        delete movie;
+    }
+
+    if (aheadFrames > 0)
+    {
+        cout << "Running " << runAhead << " frames ahead took " << (int)(aheadSeconds / aheadFrames * 1000000.0)
+             << "us per frame" << endl;
+    }
 
-        gddb->Step();
-        cpuClock += z80->Step();
+    if (rewind != NULL)
+    {
+        cout << "Rewind history: " << rewind->GetSnapshots() * rewind->GetInterval() / FramePacer::FramesPerSecond
+             << "s in " << rewind->GetUsed() / 1024 << "kB" << endl;
+        delete rewind;
+    }
 
-        if (cpuClock > CPUCLOCK_FRAME_TICKS)
+    if (audioRecorder != NULL)
+    {
+        audioRecorder->Close();
+        cout << "Recorded " << audioRecorder->GetSamplesWritten() << " audio samples, waited for the disk "
+             << audioRecorder->GetStalls() << " times" << endl;
+        if (audioRecorder->HasFailed())
+        {
+            cout << "Couldn't write all of the audio to " << dumpAudioPath << endl;
+        }
+        delete audioRecorder;
+    }
+
+    screenshots->Wait();
+    if (screenshots->GetSaved() + screenshots->GetFailed() > 0)
+    {
+        cout << "Saved " << screenshots->GetSaved() << " screenshots";
+        if (screenshots->GetFailed() > 0)
         {
-            //SDL_Delay(1000.f / 60);
-            cpuClock = 0;
-            startTime = SDL_GetTicks();
+            cout << ", " << screenshots->GetFailed() << " failed";
         }
+        cout << endl;
     }
+    delete screenshots;
+
+    if (recorder != NULL)
+    {
+        recorder->Close();
+        cout << "Recorded " << recorder->GetFramesWritten() << " frames";
+        if (recordDropDuplicates)
+        {
+            cout << " (" << recorder->GetFramesDropped() << " duplicates dropped)";
+        }
+        cout << ", waited for the disk " << recorder->GetStalls() << " times" << endl;
+        delete recorder;
+    }
+
+    if (audioOutput != NULL)
+    {
+        cout << "Audio ran dry " << audioOutput->GetUnderruns() << " times, dropped "
+             << audioOutput->GetDropped() << " samples" << endl;
+        Resampler* resampler = apu->GetResampler();
+        cout << "Resampling (" << audioQuality << ", " << resampler->GetName() << ") took "
+             << (int)(resampler->GetCost() * 1000000.0) << "us per emulated second" << endl;
+        delete audioOutput;
+    }
+
+    if (display != NULL)
+    {
+        delete display;
+        SDL_Quit();
+    }
+    delete gddb;
+    delete z80;
     return 0;
 }
 
-SDL_Renderer* GetWindowRenderer()
+Display* OpenDisplay(bool threaded, int scale, ScaleFilter filter)
 {
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
         cout << "SDL could not initialize! SDL_Error: " << SDL_GetError() << endl;
+        return NULL;
     }
-    else
+
+    if (scale == 0)
+    {
+        scale = filter == ScaleFilter::Scale3x ? 3 : filter == ScaleFilter::Scale2x ? 2 : 1;
+    }
+
+    Display* display = new Display();
+    if (!display->SetScale(scale, filter))
+    {
+        cout << "Invalid scale: " << scale << " (must be 1-" << Scaler::MaxScale << " and a multiple of the filter's scale)" << endl;
+        delete display;
+        return NULL;
+    }
+    if (!display->Open("WolfGB", threaded))
     {
-        //Create window
-        SDL_CreateWindowAndRenderer(SCREEN_WIDTH, SCREEN_HEIGHT, 0, &window, &windowRenderer);
-        if( window == NULL )
+        delete display;
+        return NULL;
+    }
+    return display;
+}
+
+/** @brief Sets the colour scheme from the --palette option
+ * Either the name of a built in scheme or 4 hex colours, lightest first.
+ *
+ * @return false if the palette couldn't be parsed
+ *
+ */
+bool SetPalette(GPU* gpu, string palette)
+{
+    if (palette == "grey" || palette == "gray")
+    {
+        gpu->SetColourScheme(ColourScheme::Grayscale);
+        return true;
+    }
+    else if (palette == "green")
+    {
+        gpu->SetColourScheme(ColourScheme::ClassicGreen);
+        return true;
+    }
+
+    uint32_t colours[4];
+    size_t pos = 0;
+    for (int i = 0; i < 4; i++)
     {
-        printf( "Window could not be created! SDL_Error: %s\n", SDL_GetError() );
+        size_t end = palette.find(',', pos);
+        if ((end == string::npos) != (i == 3))
+        {
+            return false;
         }
-        else
+
+        try
+        {
+            colours[i] = stoul(palette.substr(pos, end - pos), 0, 16) & 0xFFFFFF;
+        }
+        catch (exception& e)
         {
-            return windowRenderer;
+            return false;
         }
+        pos = end + 1;
+    }
+
+    gpu->SetCustomColours(colours);
+    gpu->SetColourScheme(ColourScheme::Custom);
+    return true;
+}
+
+/** @brief Parses the --speed option, a multiple of the real speed or "uncapped"
+ *
+ * @return false if the speed couldn't be parsed
+ *
+ */
+bool ParseSpeed(string text, double& speed)
+{
+    if (text == "uncapped" || text == "max")
+    {
+        speed = 0.0;
+        return true;
+    }
+
+    try
+    {
+        speed = stod(text);
+    }
+    catch (exception& e)
+    {
+        return false;
+    }
+    return speed > 0.0;
+}
+
+/** @brief Parses a number option, which has to be all number
+ *
+ * @return false if the text isn't a number
+ *
+ */
+bool ParseFloat(string text, float& value)
+{
+    try
+    {
+        size_t length;
+        value = stof(text, &length);
+        return length == text.size();
+    }
+    catch (exception& e)
+    {
+        return false;
+    }
+}
+
+/** @brief Parses a whole number option
+ *
+ * @return false if the text isn't a whole number or is below minimum
+ *
+ */
+bool ParseInt(string text, int& value, int minimum)
+{
+    try
+    {
+        size_t length;
+        value = stoi(text, &length);
+        return length == text.size() && value >= minimum;
+    }
+    catch (exception& e)
+    {
+        return false;
+    }
+}
+
+/** @brief Saves the frame being shown if F12 or GDDB asked for a screenshot
+ *
+ * @return void
+ *
+ */
+void CaptureRequested(Screenshots* screenshots, const uint32_t* pixels)
+{
+    string path = screenshots->CaptureRequested(pixels);
+    if (!path.empty())
+    {
+        cout << "Screenshot: " << path << endl;
+    }
+}
+
+/** @brief Which button a key is mapped to: arrows, Z = A, X = B, Enter = Start, Right Shift = Select
+ *
+ * @return false if the key isn't mapped
+ *
+ */
+bool GetJoypadButton(SDL_Keycode key, JoypadButton& button)
+{
+    switch (key)
+    {
+    case SDLK_RIGHT:
+        button = JoypadButton::Right;
+        return true;
+    case SDLK_LEFT:
+        button = JoypadButton::Left;
+        return true;
+    case SDLK_UP:
+        button = JoypadButton::Up;
+        return true;
+    case SDLK_DOWN:
+        button = JoypadButton::Down;
+        return true;
+    case SDLK_z:
+        button = JoypadButton::A;
+        return true;
+    case SDLK_x:
+        button = JoypadButton::B;
+        return true;
+    case SDLK_RSHIFT:
+        button = JoypadButton::Select;
+        return true;
+    case SDLK_RETURN:
+        button = JoypadButton::Start;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/** @brief Runs until the next frame is complete
+ * Gives up after a frame's worth of cycles, as no frames complete while the LCD is off.
+ *
+ * @return void
+ *
+ */
+void RunFrame(Z80* z80)
+{
+    uint32_t frame = z80->GetGPU()->GetFrameCount();
+    int cycles = 0;
+    while (z80->GetGPU()->GetFrameCount() == frame && cycles < 70224)
+    {
+        cycles += z80->Step();
     }
 }
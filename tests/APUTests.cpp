@@ -0,0 +1,120 @@
+#include "Test.h"
+
+#include <string.h>
+#include <vector>
+#include "Audio/APU.h"
+
+using namespace std;
+
+// Same sequence on every machine, unlike rand()
+static uint32_t Random(uint32_t& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static vector<uint8_t> SaveAPU(APU& apu)
+{
+    vector<uint8_t> buffer;
+    StateWriter state(buffer);
+    apu.SaveState(state);
+    return buffer;
+}
+
+// Silent mode skips the waveforms, so it has to move them on exactly as far as synthesis would:
+// the registers and the saved state must match an APU making sound, whatever the game writes
+TEST(SilentMatchesSound)
+{
+    APU sound;
+    APU silent;
+    silent.SetSilent(true);
+
+    sound.WriteByte(0xFF26, 0x80);
+    silent.WriteByte(0xFF26, 0x80);
+
+    uint32_t seed = 1;
+    StereoSample samples[4096];
+    int mismatches = 0;
+    for (int i = 0; i < 1000000; i++)
+    {
+        uint32_t r = Random(seed) % 1000;
+        if (r < 3)
+        {
+            uint16_t address = 0xFF10 + Random(seed) % 0x17;
+            uint8_t data = Random(seed);
+            if (Random(seed) % 4 == 0)
+            {
+                data |= 0x40; // Turns the length counter on more often than chance would
+            }
+            sound.WriteByte(address, data);
+            silent.WriteByte(address, data);
+        }
+        else if (r == 3)
+        {
+            // Mostly leaves the power on, but sometimes cycles it
+            uint8_t data = Random(seed) % 50 == 0 ? 0x00 : 0x80;
+            sound.WriteByte(0xFF26, data);
+            silent.WriteByte(0xFF26, data);
+        }
+        else if (r == 4)
+        {
+            uint16_t address = 0xFF30 + Random(seed) % 0x10;
+            uint8_t data = Random(seed);
+            sound.WriteByte(address, data);
+            silent.WriteByte(address, data);
+        }
+
+        sound.Step(4);
+        silent.Step(4);
+
+        if (i % 997 == 0)
+        {
+            for (uint16_t address = 0xFF10; address < 0xFF40; address++)
+            {
+                if (*sound.GetMemoryPtr(address) != *silent.GetMemoryPtr(address))
+                {
+                    mismatches++;
+                }
+            }
+            if (SaveAPU(sound) != SaveAPU(silent))
+            {
+                mismatches++;
+            }
+        }
+        if (i % 20000 == 19999)
+        {
+            CHECK(sound.ReadSamples(samples, 4096) > 0);
+            CHECK(silent.ReadSamples(samples, 4096) == 0);
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+// The noise channel's shift register keeps running while the channel is panned off or at
+// volume 0, so turning it back up carries on from the same place in the sequence
+TEST(NoiseRunsWhileInaudible)
+{
+    APU heard;
+    APU unheard;
+
+    heard.WriteByte(0xFF26, 0x80);
+    unheard.WriteByte(0xFF26, 0x80);
+    heard.WriteByte(0xFF25, 0xFF);
+    unheard.WriteByte(0xFF25, 0x77); // Noise panned off both sides
+    for (APU* apu : { &heard, &unheard })
+    {
+        apu->WriteByte(0xFF21, 0xF0); // Full volume, no envelope
+        apu->WriteByte(0xFF22, 0x11);
+        apu->WriteByte(0xFF23, 0x80); // Trigger
+    }
+
+    for (int i = 0; i < 10000; i++)
+    {
+        heard.Step(4);
+        unheard.Step(4);
+    }
+    unheard.WriteByte(0xFF25, 0xFF);
+
+    CHECK(SaveAPU(heard) == SaveAPU(unheard));
+}
@@ -0,0 +1,88 @@
+#include "Test.h"
+
+#include <thread>
+#include <vector>
+#include "Z80/Z80.h"
+
+using namespace std;
+
+static const int Children = 4;
+
+// Runs the machine while writing value all over work RAM, so every page the machines share
+// gets written by all of them at about the same time
+static void RunAndWrite(Z80* z80, uint8_t value)
+{
+    MMU* mmu = z80->GetMMU();
+    for (int pass = 0; pass < 4; pass++)
+    {
+        for (uint16_t address = 0xC000; address < 0xE000; address++)
+        {
+            mmu->WriteByte(address, value);
+            if (address % 64 == 0)
+            {
+                z80->Step();
+            }
+        }
+    }
+}
+
+static bool AllOf(Z80* z80, uint8_t value)
+{
+    MMU* mmu = z80->GetMMU();
+    for (uint16_t address = 0xC000; address < 0xE000; address++)
+    {
+        if (mmu->ReadByte(address) != value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(ForkedMachinesRunOnThreads)
+{
+    Z80 parent;
+    parent.GetAPU()->SetSilent(true);
+    for (uint16_t address = 0xC000; address < 0xE000; address++)
+    {
+        parent.GetMMU()->WriteByte(address, 0xEE);
+    }
+
+    Z80* children[Children];
+    for (int i = 0; i < Children; i++)
+    {
+        children[i] = new Z80();
+        children[i]->GetAPU()->SetSilent(true);
+    }
+    parent.Fork(children, Children);
+    for (int i = 0; i < Children; i++)
+    {
+        CHECK(children[i]->HashState() == parent.HashState());
+    }
+
+    vector<thread> threads;
+    threads.emplace_back(RunAndWrite, &parent, 0x80);
+    for (int i = 0; i < Children; i++)
+    {
+        threads.emplace_back(RunAndWrite, children[i], i + 1);
+    }
+    for (thread& t : threads)
+    {
+        t.join();
+    }
+
+    CHECK(AllOf(&parent, 0x80));
+    for (int i = 0; i < Children; i++)
+    {
+        CHECK(AllOf(children[i], i + 1));
+    }
+
+    // Forking again brings the children back to where the parent is
+    parent.Fork(children, Children);
+    for (int i = 0; i < Children; i++)
+    {
+        CHECK(AllOf(children[i], 0x80));
+        CHECK(children[i]->HashState() == parent.HashState());
+        delete children[i];
+    }
+}
@@ -0,0 +1,47 @@
+#include "Test.h"
+
+#include <string>
+#include <vector>
+#include "Util/Hash.h"
+
+using namespace std;
+
+// Same sequence on every machine, unlike rand()
+static uint32_t Random(uint32_t& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+// Golden hashes are compared between machines, so every version has to give the scalar hash,
+// for whole blocks, part blocks, part stripes and leftover bytes, from any alignment
+TEST(HashVersionsMatch)
+{
+    const size_t Lengths[] = { 0, 7, 63, 64, 1023, 64 * 16 + 9 };
+    const char* Versions[] = { "SSE2", "AVX2" };
+
+    vector<uint8_t> data(64 * 16 + 9 + 1);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = Random(seed);
+    }
+
+    string original = Hash::GetName();
+    for (size_t length : Lengths)
+    {
+        for (int offset = 0; offset < 2; offset++)
+        {
+            CHECK(Hash::UseVersion("scalar"));
+            uint64_t expected = Hash::Hash64(data.data() + offset, length);
+            for (const char* version : Versions)
+            {
+                if (Hash::UseVersion(version))
+                {
+                    CHECK(Hash::Hash64(data.data() + offset, length) == expected);
+                }
+            }
+        }
+    }
+    CHECK(Hash::UseVersion(original.c_str()));
+}
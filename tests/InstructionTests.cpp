@@ -0,0 +1,56 @@
+#include "Test.h"
+
+#include "Z80/Z80.h"
+
+// Puts a program in work RAM at C000 and runs that many instructions of it
+static void Run(Z80& z80, const uint8_t* program, int length, int instructions)
+{
+    MMU* mmu = z80.GetMMU();
+    for (int i = 0; i < length; i++)
+    {
+        mmu->WriteByte(0xC000 + i, program[i]);
+    }
+    z80.GetRegisters()->pc = 0xC000;
+    for (int i = 0; i < instructions; i++)
+    {
+        z80.Step();
+    }
+}
+
+// The sound registers are read through a copy, so instructions writing to (HL) have to go
+// through WriteByte or the write is lost. LD (HL+),A is how games fill wave RAM.
+TEST(HLWritesReachSoundRegisters)
+{
+    Z80 z80;
+    z80.GetAPU()->SetSilent(true);
+    MMU* mmu = z80.GetMMU();
+    mmu->WriteByte(0xFF26, 0x80);
+
+    Registers* registers = z80.GetRegisters();
+    registers->hl = 0xFF30;
+    registers->a = 0x5A;
+    const uint8_t fill[] = { 0x22, 0x22, 0x22, 0x22 }; // LD (HL+),A
+    Run(z80, fill, sizeof(fill), 4);
+    for (uint16_t address = 0xFF30; address < 0xFF34; address++)
+    {
+        CHECK(mmu->ReadByte(address) == 0x5A);
+    }
+    CHECK(registers->hl == 0xFF34);
+
+    registers->hl = 0xFF30;
+    const uint8_t bits[] =
+    {
+        0xCB, 0xC6, // SET 0,(HL)
+        0xCB, 0xBE, // RES 7,(HL)
+        0xCB, 0x36  // SWAP (HL)
+    };
+    Run(z80, bits, sizeof(bits), 3);
+    CHECK(mmu->ReadByte(0xFF30) == 0xB5);
+
+    // NR50 lives in the same registers
+    registers->hl = 0xFF24;
+    mmu->WriteByte(0xFF24, 0x00);
+    const uint8_t volume[] = { 0xCB, 0xE6 }; // SET 4,(HL)
+    Run(z80, volume, sizeof(volume), 1);
+    CHECK(mmu->ReadByte(0xFF24) == 0x10);
+}
@@ -0,0 +1,150 @@
+#include "Test.h"
+
+#include <string.h>
+#include <vector>
+#include "Memory/PagedMemory.h"
+#include "Util/Hash.h"
+
+using namespace std;
+
+// The page hashes a hashing StateWriter gets
+static vector<uint64_t> HashPages(PagedMemory& memory)
+{
+    vector<uint8_t> buffer;
+    StateWriter state(buffer, true);
+    memory.SaveState(state);
+    vector<uint64_t> hashes(buffer.size() / sizeof(uint64_t));
+    memcpy(hashes.data(), buffer.data(), buffer.size());
+    return hashes;
+}
+
+TEST(ForkedMemoryIsIsolated)
+{
+    const int Pages = 16;
+    PagedMemory parent(Pages * PagedMemory::PageSize);
+    for (int i = 0; i < Pages * PagedMemory::PageSize; i++)
+    {
+        *parent.GetWritePtr(i) = i / PagedMemory::PageSize;
+    }
+
+    PagedMemory child(Pages * PagedMemory::PageSize);
+    child.ShareFrom(parent);
+    CHECK(child.GetPages()[3] == parent.GetPages()[3]);
+
+    // Both sides write the same page, and each writes one the other doesn't
+    *child.GetWritePtr(3 * PagedMemory::PageSize) = 0xC0;
+    *parent.GetWritePtr(3 * PagedMemory::PageSize + 1) = 0xA0;
+    *child.GetWritePtr(5 * PagedMemory::PageSize) = 0xC5;
+    *parent.GetWritePtr(7 * PagedMemory::PageSize) = 0xA7;
+
+    CHECK(*child.GetPtr(3 * PagedMemory::PageSize) == 0xC0);
+    CHECK(*child.GetPtr(3 * PagedMemory::PageSize + 1) == 3);
+    CHECK(*parent.GetPtr(3 * PagedMemory::PageSize) == 3);
+    CHECK(*parent.GetPtr(3 * PagedMemory::PageSize + 1) == 0xA0);
+    CHECK(*child.GetPtr(5 * PagedMemory::PageSize) == 0xC5);
+    CHECK(*parent.GetPtr(5 * PagedMemory::PageSize) == 5);
+    CHECK(*child.GetPtr(7 * PagedMemory::PageSize) == 7);
+    CHECK(*parent.GetPtr(7 * PagedMemory::PageSize) == 0xA7);
+
+    // Pages nobody wrote are still shared, and each side copied only what it wrote. The
+    // parent copies page 3 too, even though the child has let go of it by then.
+    CHECK(child.GetPages()[0] == parent.GetPages()[0]);
+    CHECK(child.GetPagesCopied() == 2);
+    CHECK(parent.GetPagesCopied() == 2);
+
+    // Once copied, a page is written in place
+    *child.GetWritePtr(3 * PagedMemory::PageSize + 2) = 0xC2;
+    CHECK(child.GetPagesCopied() == 2);
+}
+
+TEST(ForkingAgainOnlyCopiesWrittenPages)
+{
+    const int Pages = 16;
+    PagedMemory parent(Pages * PagedMemory::PageSize);
+    PagedMemory child(Pages * PagedMemory::PageSize);
+    child.ShareFrom(parent);
+
+    *child.GetWritePtr(2 * PagedMemory::PageSize) = 1;
+    child.ShareFrom(parent);
+    CHECK(*child.GetPtr(2 * PagedMemory::PageSize) == 0);
+    for (int i = 0; i < Pages; i++)
+    {
+        CHECK(child.GetPages()[i] == parent.GetPages()[i]);
+    }
+}
+
+TEST(PageHashesFollowWrites)
+{
+    const int Pages = 8;
+    PagedMemory memory(Pages * PagedMemory::PageSize);
+    vector<uint64_t> hashes = HashPages(memory);
+    CHECK(hashes.size() == Pages);
+    for (int i = 0; i < Pages; i++)
+    {
+        CHECK(hashes[i] == Hash::Hash64(memory.GetPages()[i], PagedMemory::PageSize));
+    }
+
+    // Only the written page's hash changes, including writes straight after hashing
+    *memory.GetWritePtr(2 * PagedMemory::PageSize + 10) = 1;
+    vector<uint64_t> after = HashPages(memory);
+    for (int i = 0; i < Pages; i++)
+    {
+        CHECK((after[i] != hashes[i]) == (i == 2));
+    }
+    CHECK(after[2] == Hash::Hash64(memory.GetPages()[2], PagedMemory::PageSize));
+
+    // Writing through a pointer taken before hashing would be missed, so a second write to
+    // the same page after hashing has to be seen too
+    *memory.GetWritePtr(2 * PagedMemory::PageSize + 11) = 2;
+    CHECK(HashPages(memory)[2] == Hash::Hash64(memory.GetPages()[2], PagedMemory::PageSize));
+
+    // Putting the bytes back gives the same hashes as before
+    *memory.GetWritePtr(2 * PagedMemory::PageSize + 10) = 0;
+    *memory.GetWritePtr(2 * PagedMemory::PageSize + 11) = 0;
+    CHECK(HashPages(memory) == hashes);
+}
+
+TEST(PageHashesAreKeptAcrossForks)
+{
+    const int Pages = 8;
+    PagedMemory parent(Pages * PagedMemory::PageSize);
+    *parent.GetWritePtr(PagedMemory::PageSize) = 0x55;
+    vector<uint64_t> hashes = HashPages(parent);
+
+    PagedMemory child(Pages * PagedMemory::PageSize);
+    child.ShareFrom(parent);
+    CHECK(HashPages(child) == hashes);
+
+    // A write on one side only changes that side's hash
+    *child.GetWritePtr(PagedMemory::PageSize) = 0x66;
+    CHECK(HashPages(parent) == hashes);
+    vector<uint64_t> childHashes = HashPages(child);
+    CHECK(childHashes[1] != hashes[1]);
+    CHECK(childHashes[1] == Hash::Hash64(child.GetPages()[1], PagedMemory::PageSize));
+}
+
+TEST(LoadingStateUpdatesPageHashes)
+{
+    const int Pages = 8;
+    PagedMemory memory(Pages * PagedMemory::PageSize);
+    *memory.GetWritePtr(4 * PagedMemory::PageSize) = 0x44;
+    vector<uint64_t> hashes = HashPages(memory);
+
+    vector<uint8_t> buffer;
+    StateWriter writer(buffer);
+    writer.BeginSection(StateTag("RAM "));
+    memory.SaveState(writer);
+    writer.EndSection();
+
+    *memory.GetWritePtr(4 * PagedMemory::PageSize) = 0x00;
+    *memory.GetWritePtr(6 * PagedMemory::PageSize) = 0x66;
+    CHECK(HashPages(memory) != hashes);
+
+    StateReader reader(buffer.data(), buffer.size());
+    reader.OpenSection(StateTag("RAM "));
+    memory.LoadState(reader);
+    CHECK(!reader.Failed());
+    CHECK(*memory.GetPtr(4 * PagedMemory::PageSize) == 0x44);
+    CHECK(*memory.GetPtr(6 * PagedMemory::PageSize) == 0x00);
+    CHECK(HashPages(memory) == hashes);
+}
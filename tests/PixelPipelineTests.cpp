@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include <string.h>
+#include <string>
+#include "GPU/PixelPipeline.h"
+
+using namespace std;
+
+// Same sequence on every machine, unlike rand()
+static uint32_t Random(uint32_t& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+// Random lines through every version the CPU has must come out as they do from the scalar
+// version, including the pixels past the last whole vector
+TEST(PixelPipelineVersionsMatch)
+{
+    const int Counts[] = { 160, 1, 15, 17, 31, 33, 47 };
+    const char* Versions[] = { "SSSE3", "AVX2" };
+
+    PixelPipeline pipeline;
+    string original = pipeline.GetName();
+    const uint32_t colours[4] = { 0xFFE0F8D0, 0xFF88C070, 0xFF346856, 0xFF081820 };
+    pipeline.SetColours(colours);
+
+    uint32_t seed = 1;
+    for (int pass = 0; pass < 200; pass++)
+    {
+        uint8_t bg[160];
+        uint8_t obj[160];
+        uint8_t attributes[160];
+        for (int x = 0; x < 160; x++)
+        {
+            bg[x] = Random(seed) & 3;
+            obj[x] = Random(seed) % 2 == 0 ? 0 : Random(seed) & 3;
+            attributes[x] = Random(seed);
+        }
+        pipeline.SetPalettes(Random(seed), Random(seed), Random(seed));
+        int count = Counts[pass % 7];
+
+        uint8_t expected[160];
+        uint32_t expectedPixels[160];
+        CHECK(pipeline.UseVersion("scalar"));
+        pipeline.ComposeLine(bg, obj, attributes, expected, count);
+        pipeline.MapColours(expected, expectedPixels, count);
+
+        for (const char* version : Versions)
+        {
+            if (!pipeline.UseVersion(version))
+            {
+                continue;
+            }
+            uint8_t shades[160];
+            uint32_t pixels[160];
+            pipeline.ComposeLine(bg, obj, attributes, shades, count);
+            pipeline.MapColours(shades, pixels, count);
+            CHECK(memcmp(shades, expected, count) == 0);
+            CHECK(memcmp(pixels, expectedPixels, count * sizeof(uint32_t)) == 0);
+        }
+    }
+    CHECK(pipeline.UseVersion(original.c_str()));
+}
@@ -0,0 +1,71 @@
+#include "Test.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "Audio/Resampler.h"
+
+using namespace std;
+
+// Same sequence on every machine, unlike rand()
+static uint32_t Random(uint32_t& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static vector<StereoSample> Resample(Resampler& resampler, ResamplerQuality quality, const vector<StereoSample>& input)
+{
+    resampler.Configure(65536.0, 48000.0, quality);
+    resampler.Write(input.data(), input.size());
+    vector<StereoSample> output(input.size());
+    output.resize(resampler.Read(output.data(), output.size()));
+    return output;
+}
+
+// The vector dot products add up in a different order, so their output can round differently,
+// but never by more than 1 either side of the scalar version's
+TEST(ResamplerVersionsMatch)
+{
+    const ResamplerQuality Qualities[3] = { ResamplerQuality::Low, ResamplerQuality::Medium, ResamplerQuality::High };
+    const char* Versions[] = { "SSE", "AVX" };
+
+    Resampler resampler;
+    string original = resampler.GetName();
+
+    // Loud enough that some of the output clips
+    vector<StereoSample> input(8192);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        input[i].left = (int16_t)(Random(seed) & 0xFFFF);
+        input[i].right = (int16_t)(Random(seed) & 0xFFFF);
+    }
+
+    for (ResamplerQuality quality : Qualities)
+    {
+        CHECK(resampler.UseVersion("scalar"));
+        vector<StereoSample> expected = Resample(resampler, quality, input);
+        CHECK(expected.size() > 5000);
+
+        for (const char* version : Versions)
+        {
+            if (!resampler.UseVersion(version))
+            {
+                continue;
+            }
+            vector<StereoSample> output = Resample(resampler, quality, input);
+            CHECK(output.size() == expected.size());
+
+            int worst = 0;
+            for (size_t i = 0; i < output.size() && i < expected.size(); i++)
+            {
+                worst = max(worst, abs(output[i].left - expected[i].left));
+                worst = max(worst, abs(output[i].right - expected[i].right));
+            }
+            CHECK(worst <= 1);
+        }
+    }
+    CHECK(resampler.UseVersion(original.c_str()));
+}
@@ -0,0 +1,101 @@
+#include "Test.h"
+
+#include <vector>
+#include "State/Rewind.h"
+#include "Z80/Z80.h"
+
+using namespace std;
+
+// Changes enough of memory for the deltas to have both short and long runs of differences
+static void Change(Z80& z80, int step)
+{
+    MMU* mmu = z80.GetMMU();
+    for (int i = 0; i < 256; i += 2)
+    {
+        mmu->WriteByte(0xC000 + i, step); // Every other byte, the worst case for the encoding
+    }
+    for (int i = 0; i < 300; i++)
+    {
+        mmu->WriteByte(0xD000 + (step * 7 + i) % 0x1000, step + i);
+    }
+    z80.GetRegisters()->pc = step;
+}
+
+TEST(RewindStepsBackThroughSnapshots)
+{
+    Z80 z80;
+    Rewind rewind(1024 * 1024, 1);
+    vector<uint64_t> hashes;
+    for (int step = 0; step < 10; step++)
+    {
+        Change(z80, step);
+        rewind.Capture(&z80);
+        hashes.push_back(z80.HashState());
+    }
+    CHECK(rewind.GetSnapshots() == 10);
+
+    Change(z80, 100);
+    for (int step = 9; step >= 0; step--)
+    {
+        CHECK(rewind.Step(&z80));
+        CHECK(z80.HashState() == hashes[step]);
+        CHECK(z80.GetRegisters()->pc == step);
+    }
+    CHECK(!rewind.Step(&z80));
+    CHECK(rewind.GetSnapshots() == 1);
+
+    // Carrying on from there captures on top of what's left
+    Change(z80, 50);
+    rewind.Capture(&z80);
+    uint64_t hash = z80.HashState();
+    Change(z80, 51);
+    CHECK(rewind.Step(&z80));
+    CHECK(z80.HashState() == hash);
+    CHECK(rewind.Step(&z80));
+    CHECK(z80.HashState() == hashes[0]);
+}
+
+TEST(RewindTakesSnapshotsAtInterval)
+{
+    Z80 z80;
+    Rewind rewind(1024 * 1024, 3);
+    for (int frame = 0; frame < 9; frame++)
+    {
+        Change(z80, frame);
+        rewind.Capture(&z80);
+    }
+    // The first frame and every third after it
+    CHECK(rewind.GetSnapshots() == 3);
+    CHECK(rewind.Step(&z80));
+    CHECK(z80.GetRegisters()->pc == 6);
+    CHECK(rewind.Step(&z80));
+    CHECK(z80.GetRegisters()->pc == 3);
+}
+
+// Once the ring is full the oldest deltas go, and the ones kept still decode when they wrap
+// around the end of the ring
+TEST(RewindRingWraps)
+{
+    Z80 z80;
+    const size_t RingSize = 4000;
+    Rewind rewind(RingSize, 1);
+    vector<uint64_t> hashes;
+    for (int step = 0; step < 100; step++)
+    {
+        Change(z80, step);
+        rewind.Capture(&z80);
+        hashes.push_back(z80.HashState());
+        CHECK(rewind.GetUsed() <= RingSize);
+    }
+
+    int snapshots = rewind.GetSnapshots();
+    CHECK(snapshots > 2);
+    CHECK(snapshots < 100);
+
+    for (int step = 99; step > 99 - snapshots; step--)
+    {
+        CHECK(rewind.Step(&z80));
+        CHECK(z80.HashState() == hashes[step]);
+    }
+    CHECK(!rewind.Step(&z80));
+}
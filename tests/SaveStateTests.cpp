@@ -0,0 +1,159 @@
+#include "Test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "State/SaveState.h"
+#include "Z80/Z80.h"
+
+using namespace std;
+
+// Finds a section in a saved state's data, after the header
+static size_t FindSection(const vector<uint8_t>& data, uint32_t tag, uint32_t& size)
+{
+    size_t offset = 16;
+    while (offset + 8 <= data.size())
+    {
+        uint32_t header[2];
+        memcpy(header, &data[offset], sizeof(header));
+        offset += sizeof(header);
+        if (header[0] == tag)
+        {
+            size = header[1];
+            return offset;
+        }
+        offset += header[1];
+    }
+    return 0;
+}
+
+TEST(StateRoundTrip)
+{
+    Z80 z80;
+    MMU* mmu = z80.GetMMU();
+    mmu->WriteByte(0xC123, 0x42);
+    mmu->WriteByte(0xFFFF, 0x1F); // Interrupt enable, held in the MMU's placeholder register
+    z80.GetRegisters()->pc = 0x1234;
+    uint64_t hash = z80.HashState();
+
+    SaveState state;
+    state.Save(&z80);
+
+    mmu->WriteByte(0xC123, 0x00);
+    mmu->WriteByte(0xFFFF, 0x00);
+    z80.GetRegisters()->pc = 0x0000;
+    CHECK(z80.HashState() != hash);
+
+    CHECK(state.Load(&z80));
+    CHECK(mmu->ReadByte(0xC123) == 0x42);
+    CHECK(mmu->ReadByte(0xFFFF) == 0x1F);
+    CHECK(z80.GetRegisters()->pc == 0x1234);
+    CHECK(z80.HashState() == hash);
+}
+
+// A section that's too short is only found partway through loading. Nothing may have been
+// changed by then, including the sections before it.
+TEST(DamagedStateChangesNothing)
+{
+    Z80 z80;
+    MMU* mmu = z80.GetMMU();
+    mmu->WriteByte(0xC000, 0x11);
+
+    SaveState state;
+    state.Save(&z80);
+    vector<uint8_t> data = state.GetData();
+
+    uint32_t size = 0;
+    size_t gpu = FindSection(data, StateTag("GPU "), size);
+    CHECK(gpu != 0);
+    size--;
+    memcpy(&data[gpu - sizeof(uint32_t)], &size, sizeof(size));
+    data.erase(data.begin() + gpu + size);
+
+    mmu->WriteByte(0xC000, 0x22);
+    z80.GetRegisters()->pc = 0x4321;
+    uint64_t hash = z80.HashState();
+
+    state.SetData(data);
+    CHECK(!state.Load(&z80));
+    CHECK(strcmp(state.GetError(), "State is damaged") == 0);
+    CHECK(mmu->ReadByte(0xC000) == 0x22);
+    CHECK(z80.GetRegisters()->pc == 0x4321);
+    CHECK(z80.HashState() == hash);
+
+    // Cut short, which loses the last sections
+    data = state.GetData();
+    data.resize(data.size() / 2);
+    state.SetData(data);
+    CHECK(!state.Load(&z80));
+    CHECK(z80.HashState() == hash);
+}
+
+TEST(MappedStateRoundTrip)
+{
+    const char* path = "WolfGBTests.state";
+    Z80 z80;
+    MMU* mmu = z80.GetMMU();
+    mmu->WriteByte(0xC456, 0x77);
+    uint64_t hash = z80.HashState();
+
+    SaveState state;
+    state.Save(&z80, true);
+    CHECK(state.WriteFile(path));
+
+    mmu->WriteByte(0xC456, 0x00);
+    CHECK(state.MapFile(path));
+    CHECK(state.Load(&z80));
+    CHECK(mmu->ReadByte(0xC456) == 0x77);
+    CHECK(z80.HashState() == hash);
+
+    // The machine's RAM is the file's pages until it writes to them
+    size_t copied = z80.GetPagesCopied();
+    mmu->WriteByte(0xC456, 0x78);
+    CHECK(z80.GetPagesCopied() == copied + 1);
+
+    // Saving over the file the machine was loaded from
+    SaveState again;
+    again.Save(&z80, true);
+    CHECK(again.WriteFile(path));
+    CHECK(mmu->ReadByte(0xC456) == 0x78);
+    CHECK(mmu->ReadByte(0xC457) == 0x00);
+
+    remove(path);
+}
+
+TEST(DamagedMappedStateChangesNothing)
+{
+    const char* path = "WolfGBTests.state";
+    Z80 z80;
+    MMU* mmu = z80.GetMMU();
+
+    SaveState state;
+    state.Save(&z80, true);
+    vector<uint8_t> data = state.GetData();
+
+    // The end of the GPU section is cut off, after the MMU's RAM that would be mapped
+    uint32_t size = 0;
+    size_t gpu = FindSection(data, StateTag("GPU "), size);
+    CHECK(gpu != 0);
+    size--;
+    memcpy(&data[gpu - sizeof(uint32_t)], &size, sizeof(size));
+    data.erase(data.begin() + gpu + size);
+    state.SetData(data);
+    CHECK(state.WriteFile(path));
+
+    mmu->WriteByte(0xC000, 0x33);
+    uint64_t hash = z80.HashState();
+    size_t copied = z80.GetPagesCopied();
+
+    CHECK(state.MapFile(path));
+    CHECK(!state.Load(&z80));
+    CHECK(mmu->ReadByte(0xC000) == 0x33);
+    CHECK(z80.HashState() == hash);
+
+    // Still owns its pages, none of them point into the file
+    mmu->WriteByte(0xC000, 0x34);
+    CHECK(z80.GetPagesCopied() == copied);
+
+    remove(path);
+}
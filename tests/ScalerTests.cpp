@@ -0,0 +1,61 @@
+#include "Test.h"
+
+#include <string>
+#include <vector>
+#include "Display/Scaler.h"
+#include "GPU/GPU.h"
+
+using namespace std;
+
+// Same sequence on every machine, unlike rand()
+static uint32_t Random(uint32_t& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+// Every version the CPU has must scale a frame exactly as the scalar version does, for each
+// filter and scale. Frames of short runs of a few colours give the filters plenty of equal
+// neighbours to smooth.
+TEST(ScalerVersionsMatch)
+{
+    const uint32_t Colours[3] = { 0xFFFFFFFF, 0xFF808080, 0xFF000000 };
+    const ScaleFilter Filters[3] = { ScaleFilter::None, ScaleFilter::Scale2x, ScaleFilter::Scale3x };
+
+    Scaler scaler;
+    string original = scaler.GetName();
+
+    vector<uint32_t> frame(GPU::ScreenWidth * GPU::ScreenHeight);
+    uint32_t seed = 1;
+    uint32_t colour = Colours[0];
+    for (size_t i = 0; i < frame.size(); i++)
+    {
+        if (Random(seed) % 3 == 0)
+        {
+            colour = Colours[Random(seed) % 3];
+        }
+        frame[i] = colour;
+    }
+
+    for (ScaleFilter filter : Filters)
+    {
+        for (int scale = 1; scale <= Scaler::MaxScale; scale++)
+        {
+            if (!scaler.Configure(scale, filter))
+            {
+                continue;
+            }
+            vector<uint32_t> expected(scaler.GetWidth() * scaler.GetHeight());
+            vector<uint32_t> scaled(expected.size());
+
+            CHECK(scaler.UseVersion("scalar"));
+            scaler.Scale(frame.data(), expected.data());
+            if (scaler.UseVersion("SSE2"))
+            {
+                scaler.Scale(frame.data(), scaled.data());
+                CHECK(scaled == expected);
+            }
+        }
+    }
+    CHECK(scaler.UseVersion(original.c_str()));
+}
@@ -0,0 +1,147 @@
+#include "Test.h"
+
+#include <string.h>
+#include <vector>
+#include "State/StateStream.h"
+
+using namespace std;
+
+static vector<uint8_t> WriteSections()
+{
+    vector<uint8_t> buffer;
+    StateWriter state(buffer);
+
+    state.BeginSection(StateTag("ONE "));
+    uint32_t one = 0x12345678;
+    state.Write(one);
+    state.EndSection();
+
+    state.BeginSection(StateTag("TWO "));
+    uint8_t two[5] = { 1, 2, 3, 4, 5 };
+    state.Write(two);
+    uint16_t three = 0xBEEF;
+    state.Write(three);
+    state.EndSection();
+    return buffer;
+}
+
+TEST(SectionsRoundTrip)
+{
+    vector<uint8_t> buffer = WriteSections();
+    StateReader state(buffer.data(), buffer.size());
+
+    // Out of the order they were written in
+    CHECK(state.OpenSection(StateTag("TWO ")));
+    uint8_t two[5];
+    state.Read(two);
+    uint16_t three;
+    state.Read(three);
+    CHECK(two[0] == 1 && two[4] == 5);
+    CHECK(three == 0xBEEF);
+    state.CloseSection();
+
+    CHECK(state.OpenSection(StateTag("ONE ")));
+    uint32_t one;
+    state.Read(one);
+    CHECK(one == 0x12345678);
+    state.CloseSection();
+
+    CHECK(!state.Failed());
+}
+
+TEST(ReadingPastSectionFails)
+{
+    vector<uint8_t> buffer = WriteSections();
+    StateReader state(buffer.data(), buffer.size());
+
+    CHECK(state.OpenSection(StateTag("ONE ")));
+    uint32_t one;
+    state.Read(one);
+    CHECK(!state.Failed());
+
+    // Doesn't run on into the next section
+    uint32_t more = 0xFFFFFFFF;
+    state.Read(more);
+    CHECK(more == 0);
+    CHECK(state.Failed());
+}
+
+TEST(MissingSectionFails)
+{
+    vector<uint8_t> buffer = WriteSections();
+    StateReader state(buffer.data(), buffer.size());
+
+    CHECK(!state.HasSection(StateTag("FOUR")));
+    CHECK(!state.OpenSection(StateTag("FOUR")));
+    uint8_t value = 0xFF;
+    state.Read(value);
+    CHECK(value == 0);
+    CHECK(state.Failed());
+}
+
+TEST(TruncatedSectionIsMissing)
+{
+    vector<uint8_t> buffer = WriteSections();
+
+    // Cut into the last section, its header says it's longer than what's left
+    StateReader state(buffer.data(), buffer.size() - 1);
+    CHECK(state.HasSection(StateTag("ONE ")));
+    CHECK(!state.HasSection(StateTag("TWO ")));
+
+    // Cut into a header
+    StateReader header(buffer.data(), 6);
+    CHECK(!header.HasSection(StateTag("ONE ")));
+}
+
+TEST(SkipChecksLayout)
+{
+    vector<uint8_t> buffer = WriteSections();
+
+    StateReader state(buffer.data(), buffer.size());
+    state.OpenSection(StateTag("TWO "));
+    state.Skip(5);
+    state.Skip(sizeof(uint16_t));
+    state.CloseSection();
+    CHECK(!state.Failed());
+
+    StateReader shorter(buffer.data(), buffer.size());
+    shorter.OpenSection(StateTag("TWO "));
+    shorter.Skip(5);
+    shorter.CloseSection(); // Bytes left over
+    CHECK(shorter.Failed());
+
+    StateReader longer(buffer.data(), buffer.size());
+    longer.OpenSection(StateTag("TWO "));
+    longer.Skip(8);
+    CHECK(longer.Failed());
+}
+
+TEST(AlignPadsFromStartOfBuffer)
+{
+    vector<uint8_t> buffer;
+    StateWriter writer(buffer);
+    writer.SetAlignment(64);
+
+    writer.BeginSection(StateTag("PAGE"));
+    uint8_t first = 7;
+    writer.Write(first);
+    writer.Align();
+    size_t aligned = buffer.size();
+    uint8_t page[64];
+    memset(page, 0xAB, sizeof(page));
+    writer.Write(page);
+    writer.EndSection();
+    CHECK(aligned % 64 == 0);
+
+    StateReader state(buffer.data(), buffer.size());
+    state.OpenSection(StateTag("PAGE"));
+    uint8_t value;
+    state.Read(value);
+    CHECK(value == 7);
+    state.SkipPadding();
+    uint8_t read[64];
+    state.Read(read);
+    CHECK(memcmp(read, page, sizeof(page)) == 0);
+    state.CloseSection();
+    CHECK(!state.Failed());
+}
@@ -0,0 +1,51 @@
+#include "Test.h"
+
+#include <stdio.h>
+
+Test* Test::first = NULL;
+Test* Test::last = NULL;
+bool Test::failed = false;
+
+Test::Test(const char* name, Function function)
+{
+    this->name = name;
+    this->function = function;
+    next = NULL;
+
+    // Kept in the order they're defined in, so a file's tests run top to bottom
+    if (last == NULL)
+    {
+        first = this;
+    }
+    else
+    {
+        last->next = this;
+    }
+    last = this;
+}
+
+int Test::RunAll()
+{
+    int count = 0;
+    int failures = 0;
+    for (Test* test = first; test != NULL; test = test->next)
+    {
+        failed = false;
+        test->function();
+        printf("%s %s\n", failed ? "FAIL" : "ok  ", test->name);
+        count++;
+        if (failed)
+        {
+            failures++;
+        }
+    }
+
+    printf("%d tests, %d failed\n", count, failures);
+    return failures;
+}
+
+void Test::Fail(const char* file, int line, const char* condition)
+{
+    printf("%s:%d: CHECK(%s) failed\n", file, line, condition);
+    failed = true;
+}
@@ -0,0 +1,43 @@
+#ifndef TEST_H
+#define TEST_H
+
+/** @brief Just enough of a test framework for the Tests target
+ * TEST defines a test and registers it before main runs, so a test file only needs the tests.
+ * CHECK reports a condition that doesn't hold with its file and line, and the test carries on
+ * so one run shows everything that's wrong.
+ */
+class Test
+{
+public:
+    typedef void (*Function)();
+
+    Test(const char* name, Function function);
+
+    static int RunAll(); // Returns the number of tests that failed
+    static void Fail(const char* file, int line, const char* condition);
+
+private:
+    const char* name;
+    Function function;
+    Test* next;
+
+    static Test* first;
+    static Test* last;
+    static bool failed; // Whether the test running has failed a check
+};
+
+#define TEST(name) \
+    static void name(); \
+    static Test name##Test(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            Test::Fail(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#endif // TEST_H
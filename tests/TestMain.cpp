@@ -0,0 +1,6 @@
+#include "Test.h"
+
+int main()
+{
+    return Test::RunAll() == 0 ? 0 : 1;
+}